@@ -33,7 +33,8 @@ output_file_name()
 
 get_unique_names()
 {
-    cut -d'#' -f2 $1 \
+    grep '^[0-9]' $1 \
+        | cut -d'#' -f2 \
         | sort \
         | uniq 
 }
@@ -43,7 +44,8 @@ split_file()
     get_unique_names $1 \
         | while read NAME
     do
-        grep "# $NAME"'$' $FILE \
+        grep '^[0-9]' $FILE \
+            | grep "# $NAME"'$' \
              > "$OUTPUT_DIR/$(output_file_name $NAME)"
     done
 }
@@ -61,7 +63,7 @@ set border lw 3
 set xlabel "Searched word length"
 set ylabel "Relative speed. Higher is better."
 set title "%s"
-set xrange [ 2 : 11 ]
+set xrange [ * : * ]
 set yrange [ 0 : * ]
 set key outside center bottom horizontal Left reverse\n' \
            "$OUTPUT" "$TITLE"
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/**
+ * The alphabets are descriptors of the symbols of the keys, given as
+ * template parameters to the structures and encodings depending on them.
+ * An alphabet provides:
+ *  - static constexpr std::size_t size(), the number of symbols,
+ *  - static bool contains( char c ), which tells if c is a symbol,
+ *  - static std::size_t rank( char c ), the index of the symbol c in
+ *    [0, size()), in the order of the bytes,
+ *  - static char symbol( std::size_t rank ), the inverse of rank().
+ *
+ * The number of bits of a symbol in the codes, the fan-out of the tries
+ * and the width of their masks follow from size(), see alphabet_traits.
+ */
+
+/** The letters from 'A' to 'Z', whose rank is computed by a subtraction. */
+struct uppercase_alphabet
+{
+  static constexpr std::size_t size()
+  {
+    return 26;
+  }
+
+  static bool contains( char c )
+  {
+    return ( 'A' <= c ) && ( c <= 'Z' );
+  }
+
+  static std::size_t rank( char c )
+  {
+    return c - 'A';
+  }
+
+  static char symbol( std::size_t rank )
+  {
+    return 'A' + rank;
+  }
+};
+
+/**
+ * All the bytes but zero, such that the keys can be any UTF-8 string. The
+ * multi-byte characters are handled as a sequence of symbols.
+ */
+struct byte_alphabet
+{
+  static constexpr std::size_t size()
+  {
+    return 255;
+  }
+
+  static bool contains( char c )
+  {
+    return c != 0;
+  }
+
+  static std::size_t rank( char c )
+  {
+    return (unsigned char)c - 1;
+  }
+
+  static char symbol( std::size_t rank )
+  {
+    return char( rank + 1 );
+  }
+};
+
+namespace detail
+{
+  template< std::size_t... I >
+  struct index_list
+  {
+
+  };
+
+  template< std::size_t N, std::size_t... I >
+  struct make_index_list:
+    make_index_list< N - 1, N - 1, I... >
+  {
+
+  };
+
+  template< std::size_t... I >
+  struct make_index_list< 0, I... >
+  {
+    typedef index_list< I... > type;
+  };
+
+  /**
+   * The rank of the byte c among the given symbols, plus one, or zero if it
+   * is not one of them.
+   */
+  constexpr std::uint8_t rank_in( unsigned char, std::uint8_t )
+  {
+    return 0;
+  }
+
+  template< typename... Symbols >
+  constexpr std::uint8_t rank_in
+  ( unsigned char c, std::uint8_t next, char first, Symbols... others )
+  {
+    return ( (unsigned char)first == c )
+      ? next : rank_in( c, next + 1, others... );
+  }
+
+  typedef std::array< std::uint8_t, 256 > rank_table;
+
+  template< char... Symbols, std::size_t... I >
+  constexpr rank_table make_rank_table( index_list< I... > )
+  {
+    return rank_table{ { rank_in( I, 1, Symbols... )... } };
+  }
+}
+
+/**
+ * An alphabet made of the given symbols, which must be distinct and sorted
+ * by byte value. The rank of the symbols is read in a dense table built at
+ * compile time.
+ */
+template< char... Symbols >
+struct symbol_alphabet
+{
+  static constexpr std::size_t size()
+  {
+    return sizeof...( Symbols );
+  }
+
+  static bool contains( char c )
+  {
+    return s_ranks[ (unsigned char)c ] != 0;
+  }
+
+  static std::size_t rank( char c )
+  {
+    return s_ranks[ (unsigned char)c ] - 1;
+  }
+
+  static char symbol( std::size_t rank )
+  {
+    return s_symbols[ rank ];
+  }
+
+private:
+  static_assert( sizeof...( Symbols ) < 256, "Too many symbols." );
+
+  /** The rank plus one of each byte, zero for the bytes out of the set. */
+  static constexpr detail::rank_table s_ranks =
+    detail::make_rank_table< Symbols... >
+    ( typename detail::make_index_list< 256 >::type() );
+
+  static constexpr char s_symbols[ sizeof...( Symbols ) ] = { Symbols... };
+};
+
+template< char... Symbols >
+constexpr detail::rank_table symbol_alphabet< Symbols... >::s_ranks;
+
+template< char... Symbols >
+constexpr char symbol_alphabet< Symbols... >::s_symbols[];
+
+/** The symbols of identifiers: '-', digits, letters and '_'. */
+typedef symbol_alphabet
+<
+  '-',
+  '0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
+  'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+  'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+  '_',
+  'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+  'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z'
+> identifier_alphabet;
+
+namespace detail
+{
+  /** The smallest of 5, 6 and 8 bits able to hold size distinct values. */
+  constexpr unsigned symbol_bits( std::size_t size )
+  {
+    return ( size <= 32 ) ? 5 : ( size <= 64 ) ? 6 : 8;
+  }
+
+  constexpr unsigned bit_width( std::size_t value )
+  {
+    return ( value == 0 ) ? 0 : 1 + bit_width( value >> 1 );
+  }
+
+  /**
+   * The longest word whose symbols of the given width and its length fit
+   * in 64 bits.
+   */
+  constexpr std::size_t max_code_length( unsigned bits, std::size_t length )
+  {
+    return ( ( length + 1 ) * bits + bit_width( length + 1 ) > 64 )
+      ? length : max_code_length( bits, length + 1 );
+  }
+}
+
+/** The sizes derived from an alphabet. */
+template< typename Alphabet >
+struct alphabet_traits
+{
+  /** The bits of a symbol in the codes. */
+  static constexpr unsigned symbol_bits()
+  {
+    return detail::symbol_bits( Alphabet::size() );
+  }
+
+  /**
+   * The longest word whose code fits in 64 bits, with its length in the
+   * lowest bits.
+   */
+  static constexpr std::size_t max_code_length()
+  {
+    return detail::max_code_length( symbol_bits(), 0 );
+  }
+
+  /** The bits of the length of the word in the codes. */
+  static constexpr unsigned length_bits()
+  {
+    return 64 - symbol_bits() * max_code_length();
+  }
+
+  /** The highest number of children of a node in a trie. */
+  static constexpr std::size_t fan_out()
+  {
+    return Alphabet::size();
+  }
+
+  /** The type of the masks with a bit per symbol, void if too large. */
+  typedef typename std::conditional
+  <
+    ( Alphabet::size() <= 32 ),
+    std::uint32_t,
+    typename std::conditional
+    < ( Alphabet::size() <= 64 ), std::uint64_t, void >::type
+  >::type mask_type;
+};
+
+/** Tells if all the letters of the word are in the alphabet. */
+template< typename Alphabet >
+bool alphabet_contains( const char* word, std::size_t size )
+{
+  for ( const char* c( word ); c != word + size; ++c )
+    if ( !Alphabet::contains( *c ) )
+      return false;
+
+  return true;
+}
+
+template< typename Alphabet >
+bool alphabet_contains( const std::string& word )
+{
+  return alphabet_contains< Alphabet >( word.data(), word.size() );
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "word_view.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/** The implementations of encode_words(). */
+enum class word_encoder
+{
+  /** One letter at a time, like encode_word(). */
+  scalar,
+
+  /** A word at a time with SSE4.1 shuffles. */
+  sse41,
+
+  /** Two words at a time with AVX2 shuffles. */
+  avx2
+};
+
+/**
+ * The code given by encode_words() to the words which are not encodable. It
+ * is not the code of any word since the codes use 60 bits at most.
+ */
+constexpr std::uint64_t g_invalid_code
+( std::numeric_limits< std::uint64_t >::max() );
+
+const char* word_encoder_name( word_encoder encoder );
+
+/** Tells if the CPU can run the given implementation. */
+bool word_encoder_supported( word_encoder encoder );
+
+/** The fastest implementation supported by the CPU, chosen at first call. */
+word_encoder best_word_encoder();
+
+/**
+ * Computes the codes of count words as encode_word() would, checking in the
+ * same pass that they are encodable. The code of a word which is not is
+ * g_invalid_code. Returns the number of such words.
+ */
+std::size_t encode_words
+( const word_view* words, std::size_t count, std::uint64_t* codes );
+
+/** encode_words() with the given implementation, which must be supported. */
+std::size_t encode_words
+( word_encoder encoder, const word_view* words, std::size_t count,
+  std::uint64_t* codes );
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "memory_usage.hpp"
+#include "perf_counters.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+/** The distribution of the duration of a lookup, in nanoseconds. */
+struct latency_summary
+{
+  /** The number of measures, zero if the other fields are meaningless. */
+  std::size_t samples;
+  
+  double p50;
+  double p90;
+  double p99;
+  double p999;
+  double max;
+};
+
+/** The latency of the needles whose length is in a given range. */
+struct length_bucket
+{
+  std::size_t min_length;
+
+  /**
+   * The longest length in the bucket, std::numeric_limits< std::size_t >::max()
+   * for the overflow bucket.
+   */
+  std::size_t max_length;
+  
+  latency_summary latency;
+};
+
+/** The non empty buckets, by increasing length. */
+typedef std::vector< length_bucket > time_per_length;
+
+struct throughput_result
+{
+  double lookups_per_second;
+
+  /** The mean over the passes of the duration of a lookup. */
+  double ns_per_lookup;
+  
+  perf_counters::sample counters;
+
+  /** The half width of the 95% confidence interval of ns_per_lookup. */
+  double ci;
+
+  /** The number of measured passes over the needles. */
+  std::size_t batches;
+
+  /** The coefficient of variation of the duration of the passes. */
+  double cv;
+
+  /** Tells if the frequency of the CPU changed during the measure. */
+  bool frequency_changed;
+
+  /**
+   * Tells if the measure is unreliable, because of a high variation between
+   * the passes or a change of frequency.
+   */
+  bool noisy;
+};
+
+struct scaling_point
+{
+  std::size_t threads;
+  double lookups_per_second;
+
+  /** The highest 99th percentile of the lookup latency among the threads. */
+  std::uint64_t p99;
+};
+
+/** The measure of the lookups issued at a fixed rate. */
+struct open_loop_point
+{
+  double target_qps;
+  double achieved_qps;
+
+  /**
+   * The duration of each lookup from the time it was scheduled, thus
+   * including the time it waited behind the previous ones.
+   */
+  latency_summary latency;
+};
+
+struct open_loop_result
+{
+  /** The measures by increasing target rate, empty if disabled. */
+  std::vector< open_loop_point > points;
+
+  /**
+   * The highest target rate sustained without a surge of the latency, zero
+   * if even the first one is not.
+   */
+  double knee_qps;
+};
+
+struct engine_result
+{
+  time_per_length per_length;
+
+  /** The hardware counters per lookup during the per length measurement. */
+  perf_counters::sample counters;
+  
+  throughput_result throughput;
+  std::vector< scaling_point > scaling;
+
+  /** The latency of the lookups done after evicting the caches. */
+  latency_summary cold;
+
+  /**
+   * The throughput measured while other threads thrash the last level
+   * cache.
+   */
+  throughput_result contended;
+
+  /**
+   * The throughput of the lookups passed by batches to the engine, zero if
+   * it cannot look up batches.
+   */
+  throughput_result batched;
+
+  open_loop_result open_loop;
+};
+
+struct build_result
+{
+  std::uint64_t duration;
+
+  /**
+   * The memory retained by the structure once built, and the peak of the
+   * allocations during the build.
+   */
+  footprint memory;
+
+  /**
+   * The bytes of the structure as computed by the engine, zero if it cannot
+   * tell.
+   */
+  std::size_t reported_size;
+};
+
+struct load_result
+{
+  /** How the structure is loaded. */
+  std::string method;
+
+  std::uint64_t duration;
+  std::size_t file_size;
+};
+
+/** The measure of a sequence of lookups, insertions and removals. */
+struct update_result
+{
+  /** Zero if the engine cannot be modified or if there is no update. */
+  double operations_per_second;
+
+  latency_summary contains;
+  latency_summary insert;
+  latency_summary erase;
+
+  /**
+   * The number of operations taking more than ten times the median duration
+   * of their kind, e.g. when the structure grows.
+   */
+  std::size_t spikes;
+
+  /** The number of lookups which found their key, to check the engine. */
+  std::size_t hits;
+};
+
+/** The measure of the replay of a query log. */
+struct replay_result
+{
+  /** Zero if no log is replayed. */
+  double queries_per_second;
+
+  /** The proportion of the queries found in the dictionary. */
+  double hit_rate;
+
+  /**
+   * The duration of each query, from the time it was scheduled when the log
+   * is replayed at its recorded timing.
+   */
+  latency_summary latency;
+};
+
+/** The measure of the queries counting the words starting with a prefix. */
+struct prefix_result
+{
+  /** Zero in lookups_per_second if the engine cannot answer them. */
+  throughput_result throughput;
+
+  /** The sum of the counts, to check the engines against each other. */
+  std::size_t hits;
+};
+
+/** The speed of an implementation of encode_words(). */
+struct encoder_result
+{
+  std::string name;
+
+  /** The mean over the passes of the duration of the encoding of a word. */
+  double ns_per_word;
+  double ci;
+
+  /** The number of needles which are not encodable. */
+  std::size_t invalid;
+};
+
+struct bench_result
+{
+  build_result build;
+
+  /** One entry for each way the structure can be loaded from a file. */
+  std::vector< load_result > load;
+  
+  engine_result forward;
+  engine_result reverse;
+  throughput_result workload;
+  update_result updates;
+  replay_result replay;
+  prefix_result prefixes;
+};
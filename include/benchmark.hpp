@@ -1,5 +1,179 @@
 #pragma once
 
+#include "huge_pages.hpp"
+#include "query_log.hpp"
+#include "result_writer.hpp"
+#include "synthetic_corpus.hpp"
+#include "update_workload.hpp"
+#include "workload.hpp"
+
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
+#include <string>
+#include <vector>
+
+struct benchmark_options
+{
+  /** The names of the engines to measure, all of them if empty. */
+  std::vector< std::string > engines;
+
+  /**
+   * The engine to which the others are compared. If empty, bsearch-string
+   * is used if it is selected, otherwise the first selected engine.
+   */
+  std::string baseline;
+
+  /** The number of times each needle is looked up in the per length test. */
+  std::size_t runs;
+
+  /** The range of the lengths of the forward and reverse needles. */
+  std::size_t min_length;
+  std::size_t max_length;
+
+  /** The number of consecutive lengths in a bucket of the per length test. */
+  std::size_t bucket_width;
+
+  /**
+   * The length from which all the needles are reported in a single bucket of
+   * the per length test, zero to have as many buckets as needed.
+   */
+  std::size_t bucket_limit;
+  
+  /**
+   * The number of lookups done in each pass over the shuffled needles. Zero
+   * disables the throughput measurement.
+   */
+  std::size_t queries;
+
+  /**
+   * The passes of the throughput measurement are repeated until the half
+   * width of the 95% confidence interval of the mean is below this fraction
+   * of the mean, within min_batches and max_batches passes.
+   */
+  double target_ci;
+  std::size_t min_batches;
+  std::size_t max_batches;
+
+  /**
+   * The coefficient of variation of the passes above which a throughput is
+   * reported as noisy.
+   */
+  double noise_cv;
+
+  /** The CPU on which the main thread runs, negative to let it migrate. */
+  int cpu;
+
+  /** Whether the engines supporting it put their structure on huge pages. */
+  huge_page_mode huge_pages;
+
+  /** The seed used to shuffle the needles. */
+  std::uint32_t seed;
+
+  /**
+   * The maximum number of threads doing lookups concurrently on the same
+   * structure. Zero disables the scaling measurement.
+   */
+  std::size_t threads;
+
+  /**
+   * The number of lookups of each direction done after evicting the caches.
+   * Zero disables the cold measurement.
+   */
+  std::size_t cold_lookups;
+
+  /**
+   * The number of threads thrashing the cache during a second throughput
+   * measurement. Zero disables this measurement.
+   */
+  std::size_t noisy_neighbors;
+
+  /**
+   * The number of lookups issued at each rate of the open loop test. Zero
+   * disables this test.
+   */
+  std::size_t open_loop_requests;
+
+  /**
+   * The rate of the first step of the open loop test, in lookups per second,
+   * multiplied by open_loop_factor at each of the open_loop_steps steps.
+   */
+  double open_loop_qps;
+  double open_loop_factor;
+  std::size_t open_loop_steps;
+
+  /** The number of threads issuing the lookups of the open loop test. */
+  std::size_t open_loop_threads;
+
+  /**
+   * The number of needles passed at once to the engines which can look up
+   * batches, in a second throughput measurement. Zero disables this
+   * measurement.
+   */
+  std::size_t batch_size;
+
+  /** The highest load factor of the open addressing hash sets. */
+  double max_load_factor;
+  
+  /**
+   * The number of passes over the forward needles in the measure of the
+   * word encoders. Zero disables this measure.
+   */
+  std::size_t encoder_passes;
+  
+  /**
+   * The number of generated needles checked against the reference in the
+   * verification of the engines, before the measurements. Zero disables the
+   * verification.
+   */
+  std::size_t probes;
+  
+  /**
+   * The number of keys of the corpus kept to build the needles, zero to
+   * keep them all.
+   */
+  std::size_t sample;
+
+  /**
+   * The generator of the corpus, trained on the word list, or disabled to
+   * measure the word list itself.
+   */
+  synthetic_options synthetic;
+  
+  /** The skewed workload looked up after the forward and reverse needles. */
+  workload_options workload;
+
+  /**
+   * The number of queries counting the words starting with a prefix, for
+   * the engines able to answer them. Zero disables these queries.
+   */
+  std::size_t prefix_queries;
+
+  /**
+   * The lookups, insertions and removals applied to the engines which can be
+   * modified, after the other measurements. Ignored if the corpus is
+   * sampled.
+   */
+  update_options updates;
+
+  /** The path to a query log to replay, none if empty. */
+  std::string replay;
+  replay_timing replay_mode;
+
+  /**
+   * The factor by which the recorded timing of the log is accelerated, e.g.
+   * 2 to replay it twice as fast as recorded.
+   */
+  double replay_speed;
+
+  output_format format;
+};
 
-void bench_all( std::ostream& output, std::istream& input );
+/**
+ * Measures the engines on the sorted words read from input, or on a corpus
+ * generated from them. Returns false if
+ * the options are invalid or if an engine does not pass the verification.
+ */
+bool bench_all
+( std::ostream& output, std::istream& input,
+  const benchmark_options& options );
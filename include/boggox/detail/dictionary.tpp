@@ -1,20 +1,110 @@
+#include <algorithm>
 #include <cassert>
 
+template<typename Alphabet>
+boggox::basic_dictionary<Alphabet>::basic_dictionary()
+  : m_next( nullptr ),
+    m_terminal( false )
+{
+
+}
+
+template<typename Alphabet>
+boggox::basic_dictionary<Alphabet>::~basic_dictionary()
+{
+  delete m_next;
+}
+    
+template<typename Alphabet>
+void boggox::basic_dictionary<Alphabet>::clear()
+{
+  delete m_next;
+  m_next = nullptr;
+  m_terminal = false;
+}
+
+template<typename Alphabet>
 template<typename Iterator>
-void boggox::dictionary::insert( Iterator first, Iterator last )
+void boggox::basic_dictionary<Alphabet>::insert
+( Iterator first, Iterator last )
 {
   if ( first == last )
     m_terminal = true;
   else
     {
-      assert( 'A' <= *first );
-      assert( *first <= 'Z' );
+      assert( Alphabet::contains( *first ) );
       
       if ( m_next == nullptr )
-        m_next = new std::array<dictionary, 26>();
+        m_next = new children();
 
-      const char key( *first - 'A' );
+      const std::size_t key( Alphabet::rank( *first ) );
       ++first;
       (*m_next)[ key ].insert( first, last );
     }
 }
+    
+template<typename Alphabet>
+bool boggox::basic_dictionary<Alphabet>::terminal() const
+{
+  return m_terminal;
+}
+
+template<typename Alphabet>
+const boggox::basic_dictionary<Alphabet>*
+boggox::basic_dictionary<Alphabet>::suffixes( char key ) const
+{
+  if ( !Alphabet::contains( key ) || ( m_next == nullptr ) )
+    return nullptr;
+
+  const basic_dictionary* result( &(*m_next)[ Alphabet::rank( key ) ] );
+
+  if ( !result->m_terminal && ( result->m_next == nullptr ) )
+    return nullptr;
+  
+  return result;
+}      
+
+template<typename Alphabet>
+bool boggox::basic_dictionary<Alphabet>::contains
+( const char* word, std::size_t size ) const
+{
+  const basic_dictionary* d( this );
+  const char* const end( word + size );
+  
+  for ( const char* it( word ); it != end; ++it )
+    if ( d == nullptr )
+      return false;
+    else
+      d = d->suffixes( *it );
+
+  return ( d != nullptr ) && d->terminal();
+}
+
+template<typename Alphabet>
+bool boggox::basic_dictionary<Alphabet>::erase
+( const char* word, std::size_t size )
+{
+  if ( size == 0 )
+    {
+      const bool result( m_terminal );
+      m_terminal = false;
+      return result;
+    }
+
+  if ( !Alphabet::contains( *word ) || ( m_next == nullptr )
+       || !(*m_next)[ Alphabet::rank( *word ) ].erase( word + 1, size - 1 ) )
+    return false;
+
+  if ( std::all_of
+       ( m_next->begin(), m_next->end(),
+         []( const basic_dictionary& d ) -> bool
+         {
+           return !d.m_terminal && ( d.m_next == nullptr );
+         } ) )
+    {
+      delete m_next;
+      m_next = nullptr;
+    }
+
+  return true;
+}
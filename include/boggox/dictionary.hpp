@@ -1,17 +1,26 @@
 #pragma once
 
+#include "alphabet.hpp"
+
 #include <array>
+#include <cstddef>
+#include <string>
 #include <vector>
 
 namespace boggox
 {
-  class dictionary
+  /**
+   * A trie whose nodes have an array of children, one for each symbol of
+   * Alphabet.
+   */
+  template<typename Alphabet>
+  class basic_dictionary
   {
   public:
-    dictionary();
-    dictionary( const dictionary& ) = delete;
-    dictionary& operator=( const dictionary& ) = delete;
-    ~dictionary();
+    basic_dictionary();
+    basic_dictionary( const basic_dictionary& ) = delete;
+    basic_dictionary& operator=( const basic_dictionary& ) = delete;
+    ~basic_dictionary();
       
     void clear();
     
@@ -20,12 +29,27 @@ namespace boggox
     
     bool terminal() const;
 
-    const dictionary* suffixes( char key ) const;
+    bool contains( const char* word, std::size_t size ) const;
+
+    /**
+     * Removes the word from the dictionary, with the suffixes which become
+     * empty. Returns false if the word was not in the dictionary.
+     */
+    bool erase( const char* word, std::size_t size );
+
+    const basic_dictionary* suffixes( char key ) const;
 
   private:
-    std::array<dictionary, 'Z' - 'A' + 1>* m_next;
+    typedef
+    std::array<basic_dictionary, alphabet_traits<Alphabet>::fan_out()>
+    children;
+
+  private:
+    children* m_next;
     bool m_terminal;
   };
+
+  typedef basic_dictionary<uppercase_alphabet> dictionary;
   
   bool load_dictionary( dictionary& d, const char* filename );
   void populate_dictionary( dictionary& d, const std::vector<std::string>& w );
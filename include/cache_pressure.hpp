@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * Returns the size in bytes of the last level cache of the CPUs, or 32 MB
+ * if it cannot be queried.
+ */
+std::size_t last_level_cache_size();
+
+/**
+ * Evicts the structures from the caches by reading a buffer twice as large
+ * as the last level cache. The buffer is allocated at the first call.
+ */
+void evict_caches();
+
+/**
+ * Runs threads reading and writing buffers as large as the last level
+ * cache, as long as the instance is alive, to simulate unrelated work
+ * competing for the cache. The threads are pinned on the available CPUs
+ * other than the one of the calling thread when possible.
+ */
+class cache_thrasher
+{
+public:
+  explicit cache_thrasher( std::size_t thread_count );
+  cache_thrasher( const cache_thrasher& ) = delete;
+  cache_thrasher& operator=( const cache_thrasher& ) = delete;
+  ~cache_thrasher();
+
+private:
+  std::atomic< bool > m_stop;
+  std::vector< std::thread > m_threads;
+};
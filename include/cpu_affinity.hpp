@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Returns the identifiers of the CPUs on which the process was allowed to
+ * run at the first call, such that pinning the main thread does not
+ * restrict the other threads, or an empty vector if they cannot be queried.
+ */
+std::vector< std::size_t > available_cpus();
+
+/** The CPU on which the calling thread is running, zero if unknown. */
+std::size_t current_cpu();
+
+/**
+ * The current frequency of the given CPU in kHz as reported by cpufreq, zero
+ * if it cannot be read.
+ */
+std::uint64_t cpu_frequency( std::size_t cpu );
+
+/**
+ * Restricts the calling thread to the given CPU. Returns false if the thread
+ * could not be pinned.
+ */
+bool pin_current_thread( std::size_t cpu );
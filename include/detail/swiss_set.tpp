@@ -0,0 +1,271 @@
+#include <algorithm>
+
+#ifdef __SSE2__
+  #include <emmintrin.h>
+#endif
+
+namespace detail
+{
+  constexpr std::size_t swiss_group_size( 16 );
+  constexpr std::size_t swiss_cache_line( 64 );
+
+  /** The control bytes of the free slots, the only negative ones. */
+  constexpr std::int8_t swiss_empty( -128 );
+  constexpr std::int8_t swiss_erased( -2 );
+
+  /** The tag of a key in the control bytes, from its hash. */
+  inline std::int8_t swiss_tag( std::uint64_t hash )
+  {
+    return hash & 0x7f;
+  }
+
+  /** A bit for each of the 16 control bytes equal to value. */
+  inline std::uint32_t match_control
+  ( const std::int8_t* control, std::int8_t value )
+  {
+#ifdef __SSE2__
+    const __m128i group
+      ( _mm_loadu_si128( reinterpret_cast< const __m128i* >( control ) ) );
+
+    return _mm_movemask_epi8
+      ( _mm_cmpeq_epi8( group, _mm_set1_epi8( value ) ) );
+#else
+    std::uint32_t result( 0 );
+
+    for ( std::size_t i( 0 ); i != swiss_group_size; ++i )
+      if ( control[ i ] == value )
+        result |= std::uint32_t( 1 ) << i;
+
+    return result;
+#endif
+  }
+
+  /** A bit for each of the 16 control bytes of an empty or erased slot. */
+  inline std::uint32_t match_free( const std::int8_t* control )
+  {
+#ifdef __SSE2__
+    return _mm_movemask_epi8
+      ( _mm_loadu_si128( reinterpret_cast< const __m128i* >( control ) ) );
+#else
+    std::uint32_t result( 0 );
+
+    for ( std::size_t i( 0 ); i != swiss_group_size; ++i )
+      if ( control[ i ] < 0 )
+        result |= std::uint32_t( 1 ) << i;
+
+    return result;
+#endif
+  }
+}
+
+template< typename Key, typename Hash >
+swiss_set< Key, Hash >::swiss_set( double max_load_factor )
+  : m_max_load_factor( max_load_factor )
+{
+  rehash( 1 );
+}
+
+template< typename Key, typename Hash >
+void swiss_set< Key, Hash >::clear()
+{
+  m_control.clear();
+  m_slots.clear();
+  rehash( 1 );
+}
+
+template< typename Key, typename Hash >
+void swiss_set< Key, Hash >::insert( const Key& key )
+{
+  const std::uint64_t hash( Hash()( key ) );
+
+  if ( locate( key, hash ) != m_slots.size() )
+    return;
+
+  if ( m_used >= m_used_limit )
+    {
+      // Many erased slots are purged in place, otherwise the table grows.
+      std::size_t group_count( m_group_mask + 1 );
+
+      if ( m_size >= m_used_limit / 2 )
+        group_count *= 2;
+
+      rehash( group_count );
+    }
+
+  place( key, hash );
+}
+
+template< typename Key, typename Hash >
+void swiss_set< Key, Hash >::erase( const Key& key )
+{
+  const std::size_t slot( locate( key, Hash()( key ) ) );
+
+  if ( slot == m_slots.size() )
+    return;
+
+  // A key goes past a group only if the group has no free slot, thus if
+  // the group has an empty slot no key is behind it and the slot can be
+  // emptied.
+  const std::int8_t* const control
+    ( &m_control[ slot - slot % detail::swiss_group_size ] );
+
+  if ( detail::match_control( control, detail::swiss_empty ) != 0 )
+    {
+      m_control[ slot ] = detail::swiss_empty;
+      --m_used;
+    }
+  else
+    m_control[ slot ] = detail::swiss_erased;
+
+  --m_size;
+}
+
+template< typename Key, typename Hash >
+bool swiss_set< Key, Hash >::contains( const Key& key ) const
+{
+  return locate( key, Hash()( key ) ) != m_slots.size();
+}
+
+template< typename Key, typename Hash >
+std::size_t
+swiss_set< Key, Hash >::count( const Key* keys, std::size_t n ) const
+{
+  constexpr std::size_t batch_size( 16 );
+  std::uint64_t hashes[ batch_size ];
+  std::size_t result( 0 );
+
+  for ( std::size_t first( 0 ); first < n; first += batch_size )
+    {
+      const std::size_t count( std::min( n - first, batch_size ) );
+
+      for ( std::size_t i( 0 ); i != count; ++i )
+        {
+          const std::uint64_t hash( Hash()( keys[ first + i ] ) );
+          const std::size_t slot
+            ( ( ( hash >> 7 ) & m_group_mask ) * detail::swiss_group_size );
+
+          hashes[ i ] = hash;
+          __builtin_prefetch( &m_control[ slot ] );
+
+          // The slots of a group span several cache lines, any of which
+          // may hold the matching key.
+          const std::uintptr_t begin
+            ( reinterpret_cast< std::uintptr_t >( &m_slots[ slot ] ) );
+          const std::uintptr_t end
+            ( begin + detail::swiss_group_size * sizeof( Key ) );
+
+          for ( std::uintptr_t line
+                  ( begin & ~( detail::swiss_cache_line - 1 ) );
+                line < end; line += detail::swiss_cache_line )
+            __builtin_prefetch( reinterpret_cast< const void* >( line ) );
+        }
+
+      for ( std::size_t i( 0 ); i != count; ++i )
+        result +=
+          ( locate( keys[ first + i ], hashes[ i ] ) != m_slots.size() );
+    }
+
+  return result;
+}
+
+template< typename Key, typename Hash >
+std::size_t swiss_set< Key, Hash >::size() const
+{
+  return m_size;
+}
+
+template< typename Key, typename Hash >
+std::size_t swiss_set< Key, Hash >::memory_usage() const
+{
+  return m_control.size() * sizeof( std::int8_t )
+    + m_slots.size() * sizeof( Key );
+}
+
+/**
+ * The index of the slot of the key, whose hash is given, or the number of
+ * slots if it is not in the set.
+ */
+template< typename Key, typename Hash >
+std::size_t
+swiss_set< Key, Hash >::locate( const Key& key, std::uint64_t hash ) const
+{
+  const std::int8_t tag( detail::swiss_tag( hash ) );
+  std::size_t group( ( hash >> 7 ) & m_group_mask );
+
+  for ( std::size_t step( 1 ); ; ++step )
+    {
+      const std::size_t first( group * detail::swiss_group_size );
+      const std::int8_t* const control( &m_control[ first ] );
+
+      for ( std::uint32_t m( detail::match_control( control, tag ) ); m != 0;
+            m &= m - 1 )
+        {
+          const std::size_t slot( first + __builtin_ctz( m ) );
+
+          if ( m_slots[ slot ] == key )
+            return slot;
+        }
+
+      if ( detail::match_control( control, detail::swiss_empty ) != 0 )
+        return m_slots.size();
+
+      group = ( group + step ) & m_group_mask;
+    }
+}
+
+/**
+ * Puts the key, which is not in the set, in the first free slot of its
+ * probe sequence.
+ */
+template< typename Key, typename Hash >
+void swiss_set< Key, Hash >::place( const Key& key, std::uint64_t hash )
+{
+  std::size_t group( ( hash >> 7 ) & m_group_mask );
+
+  for ( std::size_t step( 1 ); ; ++step )
+    {
+      const std::size_t first( group * detail::swiss_group_size );
+      const std::uint32_t free( detail::match_free( &m_control[ first ] ) );
+
+      if ( free != 0 )
+        {
+          const std::size_t slot( first + __builtin_ctz( free ) );
+
+          if ( m_control[ slot ] == detail::swiss_empty )
+            ++m_used;
+
+          m_control[ slot ] = detail::swiss_tag( hash );
+          m_slots[ slot ] = key;
+          ++m_size;
+          return;
+        }
+
+      group = ( group + step ) & m_group_mask;
+    }
+}
+
+/** Moves the keys in a table of the given number of groups. */
+template< typename Key, typename Hash >
+void swiss_set< Key, Hash >::rehash( std::size_t group_count )
+{
+  const std::size_t slot_count( group_count * detail::swiss_group_size );
+
+  control_vector control
+    ( slot_count, detail::swiss_empty, m_control.get_allocator() );
+  slot_vector slots( slot_count, Key(), m_slots.get_allocator() );
+
+  m_control.swap( control );
+  m_slots.swap( slots );
+
+  m_group_mask = group_count - 1;
+  m_size = 0;
+  m_used = 0;
+
+  // At least one slot stays empty, such that the lookups stop.
+  m_used_limit =
+    std::min< std::size_t >( slot_count - 1, slot_count * m_max_load_factor );
+
+  for ( std::size_t i( 0 ); i != control.size(); ++i )
+    if ( control[ i ] >= 0 )
+      place( slots[ i ], Hash()( slots[ i ] ) );
+}
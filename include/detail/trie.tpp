@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace detail
+{
+  /** The distance from a child's offset in its parent to the child. */
+  typedef std::uint32_t flat_trie_offset;
+}
+
+template< typename Alphabet >
+void flatify( flat_trie& nodes, const trie& t )
+{
+  typedef typename alphabet_traits< Alphabet >::mask_type mask_type;
+  typedef detail::flat_trie_offset offset_type;
+
+  static_assert
+    ( !std::is_void< mask_type >::value,
+      "The flat trie needs a mask with a bit per symbol." );
+  static_assert
+    ( alphabet_traits< Alphabet >::fan_out()
+      <= std::numeric_limits< std::uint8_t >::max(),
+      "The number of children must fit in a byte." );
+  
+  std::unordered_map< const trie*, std::size_t > child_index;
+
+  std::vector< const trie* > pending( { &t } );
+  
+  for( std::size_t i( 0 ); i != pending.size(); ++i )
+  {
+    const trie* current( pending[ i ] );
+
+    child_index[ current ] = nodes.size();
+
+    const std::size_t child_count( current->keys.size() );
+    
+    nodes.push_back( child_count );
+
+    const std::size_t j( nodes.size() );
+    nodes.insert( nodes.end(), sizeof( mask_type ), 0 );
+    mask_type& letters( *reinterpret_cast< mask_type* >( &nodes[ j ] ) );
+    assert( letters == 0 );
+    
+    for ( char c : current->keys )
+      letters |= ( mask_type( 1 ) << Alphabet::rank( c ) );
+    
+    nodes.insert( nodes.end(), current->keys.begin(), current->keys.end() );
+    nodes.insert( nodes.end(), child_count * sizeof( offset_type ), 0 );
+
+    nodes.push_back( current->terminal );
+
+    pending.insert
+      ( pending.end(), current->children.begin(), current->children.end() );
+  }
+
+  std::size_t node( 0 );
+  for ( const trie* t : pending )
+    {
+      assert( nodes[ node ] == t->keys.size() );
+      
+      node += 1 + sizeof( mask_type ) + t->keys.size();
+
+      for ( const trie* c : t->children )
+        {
+          const std::size_t offset( child_index[ c ] - node );
+           
+          if ( offset > std::numeric_limits< offset_type >::max() )
+            throw std::overflow_error
+              ( "child is too far: " + std::to_string( offset ) );
+
+          *reinterpret_cast< offset_type* >( &nodes[ node ] ) = offset;
+          node += sizeof( offset_type );
+        }
+
+      assert( nodes[ node ] == t->terminal );
+      
+      ++node;
+    }
+}
+
+template< typename Alphabet >
+bool find( const flat_trie& nodes, word_view word )
+{
+  typedef typename alphabet_traits< Alphabet >::mask_type mask_type;
+  typedef detail::flat_trie_offset offset_type;
+
+  auto node( nodes.begin() );
+
+  for ( char c : word )
+    {
+      const std::size_t child_count( *node );
+      ++node;
+
+      const mask_type letters
+        ( *reinterpret_cast< const mask_type* >( &*node ) );
+
+      if ( ( letters & ( mask_type( 1 ) << Alphabet::rank( c ) ) ) == 0 )
+        return false;
+
+      node += sizeof( letters );
+      const auto begin( node );
+      const auto end( begin + child_count );
+      const auto it( std::lower_bound( begin, end, c ) );
+
+      assert( it != end );
+
+      node = end + ( it - begin ) * sizeof( offset_type );
+
+      node += *reinterpret_cast< const offset_type* >( &*node );
+    }
+
+  node += 1 + sizeof( mask_type ) + *node * ( 1 + sizeof( offset_type ) );
+  
+  return *node;
+}
@@ -0,0 +1,41 @@
+#include <cassert>
+
+template< typename Alphabet >
+std::uint64_t encode_symbols( const char* word, std::size_t size )
+{
+  typedef alphabet_traits< Alphabet > traits;
+  assert( size <= traits::max_code_length() );
+
+  std::uint64_t result( 0 );
+  const char* const end( word + size );
+
+  for ( const char* c( word ); c != end; ++c )
+    {
+      assert( Alphabet::contains( *c ) );
+      result = ( result << traits::symbol_bits() ) | Alphabet::rank( *c );
+    }
+
+  // The symbols are left-aligned, the shift being of 64 bits, thus
+  // undefined, for the empty word.
+  if ( size != 0 )
+    result <<= 64 - traits::symbol_bits() * size;
+
+  return result | size;
+}
+
+template< typename Alphabet >
+std::string decode_symbols( std::uint64_t code )
+{
+  typedef alphabet_traits< Alphabet > traits;
+
+  std::string result
+    ( code & ( ( std::uint64_t( 1 ) << traits::length_bits() ) - 1 ), ' ' );
+
+  for ( char& c : result )
+    {
+      c = Alphabet::symbol( code >> ( 64 - traits::symbol_bits() ) );
+      code <<= traits::symbol_bits();
+    }
+
+  return result;
+}
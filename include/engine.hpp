@@ -0,0 +1,332 @@
+#pragma once
+
+#include "bench_result.hpp"
+#include "key_source.hpp"
+#include "measure.hpp"
+#include "word_encoding.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * A structure answering whether a word is in a dictionary. The engines are
+ * created by name via the engine_registry, built from a word list, then
+ * measured.
+ */
+class engine
+{
+public:
+  virtual ~engine();
+
+  /**
+   * Builds the structure from the given sorted and distinct keys, consumed
+   * as they come such that the engine decides what it stores.
+   */
+  virtual void build( key_source& keys ) = 0;
+
+  /**
+   * Tells if the word is in the structure. This is used to check the
+   * structure, not in the timed loops.
+   */
+  virtual bool contains( const std::string& word ) const = 0;
+
+  /**
+   * Tells if the structure can store the given word. The engines which do not
+   * support all the words of the corpus are not measured.
+   */
+  virtual bool supports( const std::string& word ) const;
+
+  /** Runs the lookup benchmarks with the given needles. */
+  virtual bench_result measure( const needle_set& needles ) const = 0;
+
+  /**
+   * Counts the words of the structure starting with the given prefix.
+   * Returns false if the engine cannot answer prefix queries.
+   */
+  virtual bool count_prefix
+  ( const std::string& prefix, std::size_t& count ) const;
+
+  /**
+   * Measures the throughput of the prefix queries on the given prefixes,
+   * summing the counts in result.hits. Returns false if the engine cannot
+   * answer prefix queries.
+   */
+  virtual bool measure_prefixes
+  ( const needle_arena& prefixes, prefix_result& result ) const;
+
+  /**
+   * Measures the lookups of the forward and reverse needles passed by
+   * batches of g_batch_size needles, in the batched fields of result.
+   * Returns false if the engine cannot look up batches.
+   */
+  virtual bool measure_batches
+  ( const needle_set& needles, bench_result& result ) const;
+
+  /**
+   * Applies the given lookups, insertions and removals to the structure and
+   * measures them. Returns false if the structure cannot be modified.
+   */
+  virtual bool measure_updates
+  ( const update_workload& updates, update_result& result );
+
+  /**
+   * Writes the structure in the given file. Returns false if it is not
+   * supported or if it failed.
+   */
+  virtual bool save( const std::string& path ) const;
+
+  /**
+   * The ways in which this engine can load a structure written by save(),
+   * e.g. "read" or "mmap". Empty if the engine cannot be serialized.
+   */
+  virtual std::vector< std::string > load_methods() const;
+  
+  /**
+   * Replaces the structure with the one in the given file, via the given
+   * method from load_methods(). Returns false on failure.
+   */
+  virtual bool load( const std::string& path, const std::string& method );
+
+  /**
+   * Tells if the engine allocates its structure on huge pages when
+   * g_huge_pages is set at its creation.
+   */
+  virtual bool uses_huge_pages() const;
+
+  /**
+   * The bytes used by the structure as it computes them, zero if it cannot
+   * tell.
+   */
+  virtual std::size_t memory_usage() const;
+};
+
+/**
+ * The base of the engines looking up needles of type Needle, computed from
+ * the words via Derived::prepare( word_view ). The lookups are
+ * done by calling Derived::lookup( const Needle& ) const, which is not
+ * virtual such that it can be inlined in the timed loops.
+ */
+template< typename Derived, typename Needle >
+class lookup_engine:
+  public engine
+{
+public:
+  bool contains( const std::string& word ) const override
+  {
+    return derived().lookup( Derived::prepare( word ) );
+  }
+  
+  bench_result measure( const needle_set& needles ) const override
+  {
+    const Derived& self( derived() );
+    
+    return ::measure
+      ( prepare( needles.forward ), prepare( needles.reverse ),
+        prepare( needles.workload ), prepare( needles.replay ), needles,
+        [ &self ]( const Needle& n ) -> bool
+        {
+          return self.lookup( n );
+        } );
+  }
+
+protected:
+  /**
+   * Implements measure_batches() via
+   * Derived::lookup_batch( const Needle*, std::size_t ) const, which returns
+   * the number of needles found. Only the engines providing this function
+   * call it.
+   */
+  void measure_batch_lookups
+  ( const needle_set& needles, bench_result& result ) const
+  {
+    const Derived& self( derived() );
+    const auto f
+      ( [ &self ]( const Needle* n, std::size_t count ) -> std::size_t
+        {
+          return self.lookup_batch( n, count );
+        } );
+
+    result.forward.batched =
+      run_batches( prepare( needles.forward ), needles, f );
+    result.reverse.batched =
+      run_batches( prepare( needles.reverse ), needles, f );
+  }
+
+  static std::vector< Needle > prepare( const needle_arena& words )
+  {
+    const std::size_t count( words.size() );
+    std::vector< Needle > result;
+    result.reserve( count );
+
+    for ( std::size_t i( 0 ); i != count; ++i )
+      result.push_back( Derived::prepare( words[ i ] ) );
+
+    return result;
+  }
+
+private:
+  const Derived& derived() const
+  {
+    return static_cast< const Derived& >( *this );
+  }
+};
+
+/**
+ * The base of the engines whose structure can be modified after the build,
+ * via Derived::insert( const Needle& ) and Derived::erase( const Needle& ),
+ * which are only called for absent and present keys respectively.
+ */
+template< typename Derived, typename Needle >
+class mutable_lookup_engine:
+  public lookup_engine< Derived, Needle >
+{
+public:
+  bool measure_updates
+  ( const update_workload& updates, update_result& result ) override
+  {
+    Derived& self( static_cast< Derived& >( *this ) );
+
+    result =
+      run_updates
+      ( lookup_engine< Derived, Needle >::prepare( updates.keys ), updates,
+        [ &self ]( const Needle& n ) -> bool
+        {
+          return self.lookup( n );
+        },
+        [ &self ]( const Needle& n ) -> void
+        {
+          self.insert( n );
+        },
+        [ &self ]( const Needle& n ) -> void
+        {
+          self.erase( n );
+        } );
+
+    return true;
+  }
+};
+
+/**
+ * Implements the prefix queries of an engine Base storing the codes given
+ * by ordered_word_encoding, in which the words starting with a prefix are
+ * those whose codes are in a range. Derived counts the codes of a range
+ * via std::size_t count_codes( std::uint64_t first, std::uint64_t last )
+ * const, with first <= last.
+ */
+template< typename Derived, typename Base >
+class ordered_prefix_engine:
+  public Base
+{
+private:
+  /** The first and last codes of the words starting with a prefix. */
+  typedef std::pair< std::uint64_t, std::uint64_t > code_range;
+
+public:
+  bool count_prefix
+  ( const std::string& prefix, std::size_t& count ) const override
+  {
+    count = prefix_count( prepare_prefix( prefix ) );
+    return true;
+  }
+
+  bool measure_prefixes
+  ( const needle_arena& prefixes, prefix_result& result ) const override
+  {
+    std::vector< code_range > needles;
+    needles.reserve( prefixes.size() );
+
+    for ( std::size_t i( 0 ); i != prefixes.size(); ++i )
+      needles.push_back( prepare_prefix( prefixes[ i ] ) );
+
+    result.hits = 0;
+
+    for ( const code_range& r : needles )
+      result.hits += prefix_count( r );
+
+    result.throughput =
+      run_throughput
+      ( needles,
+        [ this ]( const code_range& r ) -> std::size_t
+        {
+          return prefix_count( r );
+        } );
+
+    return true;
+  }
+
+private:
+  /**
+   * The range of the codes of the words starting with the prefix, an empty
+   * range if no encodable word can start with it.
+   */
+  static code_range prepare_prefix( word_view prefix )
+  {
+    code_range result( 1, 0 );
+
+    if ( is_encodable< std::uint64_t, ordered_word_encoding >
+         ( prefix.str() ) )
+      ordered_prefix_range
+        ( prefix.data, prefix.size, result.first, result.second );
+
+    return result;
+  }
+
+  std::size_t prefix_count( const code_range& range ) const
+  {
+    if ( range.first > range.second )
+      return 0;
+
+    return static_cast< const Derived& >( *this ).count_codes
+      ( range.first, range.second );
+  }
+};
+
+/** Tells if the engine supports every key of the stream. */
+bool supports_all( const engine& e, key_source& keys );
+
+typedef std::function< std::unique_ptr< engine >() > engine_factory;
+
+/** The engines available in the benchmark, by name. */
+class engine_registry
+{
+public:
+  static void add( const std::string& name, const engine_factory& factory );
+
+  /** Returns the names of the registered engines, in alphabetical order. */
+  static std::vector< std::string > names();
+
+  /** Creates the engine of the given name, nullptr if there is none. */
+  static std::unique_ptr< engine > create( const std::string& name );
+};
+
+/**
+ * Registers an engine at static initialization time. Each engine declares
+ * an instance of this type in its translation unit.
+ */
+struct engine_registration
+{
+  engine_registration( const std::string& name, const engine_factory& factory );
+};
+
+/**
+ * Registers an engine of type T, created by its default constructor, under
+ * the given name.
+ */
+template< typename T >
+struct register_engine:
+  public engine_registration
+{
+  explicit register_engine( const std::string& name )
+    : engine_registration
+      ( name,
+        []() -> std::unique_ptr< engine >
+        {
+          return std::unique_ptr< engine >( new T() );
+        } )
+  {
+
+  }
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/** Whether and how the engines use huge pages in a benchmark. */
+enum class huge_page_mode
+{
+  off,
+  on,
+
+  /** Each engine using huge pages is measured with and without them. */
+  compare
+};
+
+/**
+ * Tells if the large buffers of the engines created from now on are
+ * allocated on huge pages.
+ */
+extern bool g_huge_pages;
+
+/** The size of the huge pages on x86-64. */
+constexpr std::size_t huge_page_size( 2 * 1024 * 1024 );
+
+/**
+ * Maps the given number of bytes, rounded up to a multiple of
+ * huge_page_size, on explicit huge pages if some were reserved via
+ * /proc/sys/vm/nr_hugepages, otherwise on transparent huge pages requested
+ * via madvise(2). Returns nullptr on failure.
+ */
+void* allocate_huge_pages( std::size_t bytes );
+
+/** Releases the memory returned by allocate_huge_pages( bytes ). */
+void release_huge_pages( void* p, std::size_t bytes );
+
+/**
+ * An allocator putting the large blocks on huge pages if g_huge_pages was
+ * set when it was constructed. The blocks smaller than a huge page are
+ * allocated via operator new, since they would waste most of the page.
+ */
+template< typename T >
+class huge_page_allocator
+{
+public:
+  typedef T value_type;
+
+  template< typename U >
+  friend class huge_page_allocator;
+  
+public:
+  huge_page_allocator()
+    : m_enabled( g_huge_pages )
+  {
+
+  }
+
+  template< typename U >
+  huge_page_allocator( const huge_page_allocator< U >& that )
+    : m_enabled( that.m_enabled )
+  {
+
+  }
+
+  T* allocate( std::size_t n )
+  {
+    const std::size_t bytes( n * sizeof( T ) );
+
+    if ( !on_huge_pages( bytes ) )
+      return static_cast< T* >( ::operator new( bytes ) );
+
+    void* const result( allocate_huge_pages( bytes ) );
+
+    if ( result == nullptr )
+      throw std::bad_alloc();
+
+    return static_cast< T* >( result );
+  }
+
+  void deallocate( T* p, std::size_t n )
+  {
+    const std::size_t bytes( n * sizeof( T ) );
+
+    if ( on_huge_pages( bytes ) )
+      release_huge_pages( p, bytes );
+    else
+      ::operator delete( p );
+  }
+
+  template< typename U >
+  bool operator==( const huge_page_allocator< U >& that ) const
+  {
+    return m_enabled == that.m_enabled;
+  }
+
+  template< typename U >
+  bool operator!=( const huge_page_allocator< U >& that ) const
+  {
+    return m_enabled != that.m_enabled;
+  }
+
+private:
+  bool on_huge_pages( std::size_t bytes ) const
+  {
+    return m_enabled && ( bytes >= huge_page_size );
+  }
+
+private:
+  bool m_enabled;
+};
+
+bool parse_huge_page_mode( huge_page_mode& result, const char* name );
+const char* huge_page_mode_name( huge_page_mode mode );
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "mix_hash.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * A word of at most 15 bytes stored in place, with its length in the last
+ * byte. The unused bytes are zero, such that two words are compared as two
+ * 64-bit integers.
+ */
+struct inline_string
+{
+  static constexpr std::size_t capacity = 15;
+
+  /** The empty word. */
+  inline_string()
+  {
+    words[ 0 ] = 0;
+    words[ 1 ] = 0;
+  }
+
+  /**
+   * Stores the given word. A word longer than capacity gets a value which is
+   * never equal to a shorter word.
+   */
+  inline_string( const char* word, std::size_t size )
+  {
+    if ( size > capacity )
+      {
+        words[ 0 ] = UINT64_MAX;
+        words[ 1 ] = UINT64_MAX;
+        return;
+      }
+
+    char bytes[ sizeof( words ) ] = {};
+    std::memcpy( bytes, word, size );
+    bytes[ capacity ] = size;
+    std::memcpy( words, bytes, sizeof( words ) );
+  }
+
+  bool operator==( const inline_string& that ) const
+  {
+    return ( words[ 0 ] == that.words[ 0 ] )
+      && ( words[ 1 ] == that.words[ 1 ] );
+  }
+
+  bool operator!=( const inline_string& that ) const
+  {
+    return !( *this == that );
+  }
+
+  std::uint64_t words[ 2 ];
+};
+
+struct inline_string_hash
+{
+  std::size_t operator()( const inline_string& s ) const noexcept
+  {
+    return mix_hash( s.words[ 0 ] ^ ( s.words[ 1 ] * 0x9e3779b97f4a7c15ull ) );
+  }
+};
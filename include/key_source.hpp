@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * A stream of sorted and distinct keys. The engines are built from such a
+ * stream such that the keys do not have to be stored all at once.
+ */
+class key_source
+{
+public:
+  virtual ~key_source();
+
+  /** Gets the next key. Returns false at the end of the stream. */
+  virtual bool next( std::string& key ) = 0;
+};
+
+/** Streams the words of a vector. */
+class vector_key_source:
+  public key_source
+{
+public:
+  explicit vector_key_source( const std::vector< std::string >& words );
+
+  bool next( std::string& key ) override;
+
+private:
+  const std::vector< std::string >& m_words;
+  std::size_t m_index;
+};
+
+/** A set of keys which can be streamed as many times as needed. */
+class corpus
+{
+public:
+  virtual ~corpus();
+
+  /** Returns a new stream over all the keys, from the first one. */
+  virtual std::unique_ptr< key_source > keys() const = 0;
+};
+
+/** A corpus whose keys are stored in a sorted vector. */
+class word_list_corpus:
+  public corpus
+{
+public:
+  explicit word_list_corpus( const std::vector< std::string >& words );
+
+  std::unique_ptr< key_source > keys() const override;
+
+private:
+  const std::vector< std::string >& m_words;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Counts durations in buckets whose width grows with the values, such that
+ * every value is recorded with a relative error below 2^-6, about 1.6%, in
+ * constant time and memory, as in an HDR histogram.
+ */
+class latency_histogram
+{
+public:
+  latency_histogram();
+
+  void record( std::uint64_t value );
+
+  /** Adds the values recorded in that to this histogram. */
+  void merge( const latency_histogram& that );
+  
+  std::uint64_t count() const;
+  std::uint64_t max() const;
+
+  /**
+   * Returns the highest value equivalent to the value at the given quantile
+   * q in [0, 1], zero if there is no value.
+   */
+  std::uint64_t percentile( double q ) const;
+
+private:
+  static std::size_t bucket_index( std::uint64_t value );
+  static std::uint64_t highest_equivalent_value( std::size_t index );
+  
+private:
+  std::vector< std::uint64_t > m_counts;
+  std::uint64_t m_count;
+  std::uint64_t m_max;
+};
@@ -0,0 +1,757 @@
+#pragma once
+
+#include "bench_result.hpp"
+#include "cache_pressure.hpp"
+#include "cpu_affinity.hpp"
+#include "latency_histogram.hpp"
+#include "needle_arena.hpp"
+#include "perf_counters.hpp"
+#include "statistics.hpp"
+#include "update_workload.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/** The number of times each needle is looked up in the per length test. */
+extern std::size_t g_runs;
+
+/**
+ * The bounds of the number of passes in the throughput test. The lower one
+ * is at least two, since a single pass has no confidence interval.
+ */
+extern std::size_t g_min_batches;
+extern std::size_t g_max_batches;
+
+/**
+ * The passes of the throughput test are repeated until the half width of the
+ * confidence interval of the mean is below this fraction of the mean.
+ */
+extern double g_target_ci;
+
+/**
+ * The coefficient of variation of the passes above which the throughput
+ * measure is flagged as noisy.
+ */
+extern double g_noise_cv;
+
+/** The highest number of threads in the scaling test, zero to disable it. */
+extern std::size_t g_scaling_threads;
+
+/**
+ * The number of lookups done each after evicting the caches, zero to
+ * disable the cold test.
+ */
+extern std::size_t g_cold_lookups;
+
+/**
+ * The number of threads thrashing the cache during the contended throughput
+ * test, zero to disable it.
+ */
+extern std::size_t g_noisy_neighbors;
+
+/**
+ * The number of lookups issued at each rate of the open loop test, zero to
+ * disable it.
+ */
+extern std::size_t g_open_loop_requests;
+
+/**
+ * The rate of the first step of the open loop test, in lookups per second,
+ * multiplied by g_open_loop_factor at each of the g_open_loop_steps steps.
+ */
+extern double g_open_loop_qps;
+extern double g_open_loop_factor;
+extern std::size_t g_open_loop_steps;
+
+/** The number of threads issuing the lookups of the open loop test. */
+extern std::size_t g_open_loop_threads;
+
+/**
+ * The number of needles passed at once to the engines looking up needles
+ * by batches, zero to disable the batch test.
+ */
+extern std::size_t g_batch_size;
+
+/** The number of consecutive lengths in a bucket of the per length test. */
+extern std::size_t g_bucket_width;
+
+/**
+ * The length from which all the needles fall in a single overflow bucket of the
+ * per length test, zero for no overflow bucket.
+ */
+extern std::size_t g_bucket_limit;
+
+std::chrono::nanoseconds now();
+
+/** The hardware counters of the main thread. */
+perf_counters& hardware_counters();
+
+/**
+ * Divides the counts in sample by the given number of lookups, keeping the
+ * unavailable counters as is.
+ */
+perf_counters::sample per_lookup
+( perf_counters::sample sample, std::size_t lookups );
+
+/**
+ * Computes the percentiles of the given durations, which are sorted in the
+ * process.
+ */
+latency_summary summarize_latency( std::vector< double >& durations );
+latency_summary summarize_latency( const latency_histogram& durations );
+
+/** The index of the bucket of the per length test receiving a needle. */
+std::size_t length_bucket_index( std::size_t length );
+
+/** The bucket of the per length test at the given index, without latency. */
+length_bucket make_length_bucket( std::size_t index );
+
+template <class T>
+void do_not_optimize_away(T&& datum)
+{
+  if (getpid() == 1)
+    {
+      const void* p = &datum;
+      putchar(*static_cast<const char*>(p));
+    }
+}
+
+template< typename T, typename F >
+time_per_length run_benchmark
+( const std::vector< T >& words, const std::vector< std::size_t >& length,
+  perf_counters::sample& counters, F&& f )
+{
+  const std::size_t count( words.size() );
+  assert( count == length.size() );
+  
+  std::vector< std::vector< double > > durations;
+
+  hardware_counters().start();
+  
+  for ( std::size_t i( 0 ); i != count; ++i )
+    {
+      const std::chrono::nanoseconds start( now() );
+
+      for ( std::size_t r( 0 ); r != g_runs; ++r )
+        do_not_optimize_away( f( words[ i ] ) );
+      
+      const double duration( double( ( now() - start ).count() ) / g_runs );
+      const std::size_t bucket( length_bucket_index( length[ i ] ) );
+
+      if ( bucket >= durations.size() )
+        durations.resize( bucket + 1 );
+      
+      durations[ bucket ].push_back( duration );
+    }
+
+  counters = per_lookup( hardware_counters().stop(), count * g_runs );
+
+  time_per_length result;
+
+  for ( std::size_t i( 0 ); i != durations.size(); ++i )
+    {
+      std::vector< double >& d( durations[ i ] );
+
+      if ( d.empty() )
+        continue;
+      
+      result.push_back( make_length_bucket( i ) );
+      result.back().latency = summarize_latency( d );
+    }
+  
+  return result;
+}
+
+template< typename T >
+std::vector< T > make_stream
+( const std::vector< T >& needles,
+  const std::vector< std::size_t >& query_order )
+{
+  std::vector< T > result;
+  result.reserve( query_order.size() );
+
+  for ( std::size_t i : query_order )
+    result.push_back( needles[ i ] );
+
+  return result;
+}
+
+/**
+ * Looks up the items of the stream in a single sweep per pass, after an
+ * untimed pass to warm up the caches and the branch predictors. The passes
+ * are repeated until the mean duration of a lookup is known precisely
+ * enough, as defined by g_target_ci, within g_min_batches and g_max_batches
+ * passes. The items of the stream stand for the given number of lookups in
+ * total, e.g. when they are batches of needles.
+ */
+template< typename T, typename F >
+throughput_result run_throughput
+( const std::vector< T >& stream, std::size_t lookups, F&& f )
+{
+  const std::size_t count( lookups );
+  assert( count != 0 );
+
+  std::size_t hits( 0 );
+
+  for ( const T& w : stream )
+    hits += f( w );
+
+  do_not_optimize_away( hits );
+
+  const std::size_t cpu( current_cpu() );
+  std::uint64_t min_frequency( cpu_frequency( cpu ) );
+  std::uint64_t max_frequency( min_frequency );
+  
+  std::vector< double > ns_per_lookup;
+  ns_per_lookup.reserve( g_max_batches );
+  sample_summary summary;
+
+  hardware_counters().start();
+
+  do
+    {
+      hits = 0;
+      const std::chrono::nanoseconds start( now() );
+
+      for ( const T& w : stream )
+        hits += f( w );
+
+      ns_per_lookup.push_back( double( ( now() - start ).count() ) / count );
+      do_not_optimize_away( hits );
+
+      const std::uint64_t frequency( cpu_frequency( cpu ) );
+      min_frequency = std::min( min_frequency, frequency );
+      max_frequency = std::max( max_frequency, frequency );
+      
+      summary = summarize( ns_per_lookup );
+    }
+  while ( ( ns_per_lookup.size() < g_max_batches )
+          && ( ( ns_per_lookup.size() < g_min_batches )
+               || ( summary.ci > g_target_ci * summary.mean ) ) );
+
+  throughput_result result;
+  result.counters =
+    per_lookup
+    ( hardware_counters().stop(), count * ns_per_lookup.size() );
+  
+  result.ns_per_lookup = std::max( 1e-3, summary.mean );
+  result.lookups_per_second = 1e9 / result.ns_per_lookup;
+  result.ci = summary.ci;
+  result.batches = ns_per_lookup.size();
+  result.cv = summary.cv;
+
+  // The reported frequency varies a bit even on an idle CPU, thus only
+  // large changes are considered.
+  result.frequency_changed = ( max_frequency > min_frequency * 1.05 );
+  result.noisy = result.frequency_changed || ( summary.cv > g_noise_cv );
+
+  return result;
+}
+
+/** Measures the throughput of the lookups of the needles of the stream. */
+template< typename T, typename F >
+throughput_result run_throughput( const std::vector< T >& stream, F&& f )
+{
+  return run_throughput( stream, stream.size(), f );
+}
+
+/**
+ * Looks up g_cold_lookups needles spread over the given ones, each after
+ * evicting the caches, and timing each lookup individually.
+ */
+template< typename T, typename F >
+latency_summary run_cold( const std::vector< T >& needles, F& f )
+{
+  const std::size_t count( needles.size() );
+  assert( count != 0 );
+
+  std::vector< double > durations;
+  durations.reserve( g_cold_lookups );
+
+  for ( std::size_t i( 0 ); i != g_cold_lookups; ++i )
+    {
+      const T& w( needles[ i * count / g_cold_lookups ] );
+      evict_caches();
+
+      const std::chrono::nanoseconds start( now() );
+      do_not_optimize_away( f( w ) );
+      durations.push_back( ( now() - start ).count() );
+    }
+
+  return summarize_latency( durations );
+}
+
+/**
+ * Looks up the needles from thread_count threads pinned on distinct CPUs
+ * when possible. Each thread walks the whole stream, starting at its own
+ * offset, once untimed to compute the aggregated throughput, then once
+ * again timing each lookup to compute its latency percentile.
+ */
+template< typename T, typename F >
+scaling_point run_threads
+( const std::vector< T >& stream, std::size_t thread_count, F& f )
+{
+  const std::size_t count( stream.size() );
+  const std::vector< std::size_t > cpus( available_cpus() );
+
+  std::vector< std::chrono::nanoseconds > starts( thread_count );
+  std::vector< std::chrono::nanoseconds > ends( thread_count );
+  std::vector< std::uint64_t > p99( thread_count );
+
+  // Each phase starts once all the threads have reached it, such that the
+  // timed lookups of each thread run concurrently with the timed lookups of
+  // the others.
+  std::atomic< std::size_t > ready( 0 );
+  std::atomic< std::size_t > done( 0 );
+  const auto wait
+    ( [ thread_count ]( std::atomic< std::size_t >& barrier ) -> void
+      {
+        ++barrier;
+        while ( barrier.load() != thread_count )
+          std::this_thread::yield();
+      } );
+  
+  std::vector< std::thread > threads;
+  threads.reserve( thread_count );
+
+  for ( std::size_t t( 0 ); t != thread_count; ++t )
+    threads.emplace_back
+      ( [ & ]( std::size_t index ) -> void
+        {
+          if ( !cpus.empty() )
+            pin_current_thread( cpus[ index % cpus.size() ] );
+
+          const std::size_t offset( index * count / thread_count );
+          std::vector< std::uint32_t > latencies( count );
+          std::size_t hits( 0 );
+
+          wait( ready );
+          starts[ index ] = now();
+
+          for ( std::size_t i( offset ); i != count; ++i )
+            hits += f( stream[ i ] );
+          for ( std::size_t i( 0 ); i != offset; ++i )
+            hits += f( stream[ i ] );
+
+          ends[ index ] = now();
+          wait( done );
+          
+          for ( std::size_t i( 0 ); i != count; ++i )
+            {
+              const T& w( stream[ ( offset + i ) % count ] );
+              const std::chrono::nanoseconds start( now() );
+              hits += f( w );
+              latencies[ i ] = ( now() - start ).count();
+            }
+
+          do_not_optimize_away( hits );
+
+          const auto q( latencies.begin() + count * 99 / 100 );
+          std::nth_element( latencies.begin(), q, latencies.end() );
+          p99[ index ] = *q;
+        },
+        t );
+
+  for ( std::thread& t : threads )
+    t.join();
+
+  const double duration
+    ( std::max< std::uint64_t >
+      ( 1,
+        ( *std::max_element( ends.begin(), ends.end() )
+          - *std::min_element( starts.begin(), starts.end() ) ).count() ) );
+  
+  return scaling_point
+    {
+      thread_count,
+      thread_count * count * 1e9 / duration,
+      *std::max_element( p99.begin(), p99.end() )
+    };
+}
+
+template< typename T, typename F >
+std::vector< scaling_point > run_scaling
+( const std::vector< T >& stream, F& f )
+{
+  std::vector< scaling_point > result;
+  result.reserve( g_scaling_threads );
+  
+  for ( std::size_t t( 1 ); t <= g_scaling_threads; ++t )
+    result.push_back( run_threads( stream, t, f ) );
+
+  return result;
+}
+
+/**
+ * Issues g_open_loop_requests lookups at the given rate, spread over
+ * g_open_loop_threads threads. Each lookup has a scheduled time and its
+ * latency is measured from this time, not from when the thread gets to it.
+ * Thus a slow lookup delays the following ones and their latency accounts
+ * for it, instead of hiding it by issuing fewer lookups.
+ */
+template< typename T, typename F >
+open_loop_point run_open_loop
+( const std::vector< T >& stream, double qps, F& f )
+{
+  const std::size_t count( stream.size() );
+  const std::size_t thread_count( g_open_loop_threads );
+  const std::vector< std::size_t > cpus( available_cpus() );
+  const double interval( 1e9 / qps );
+
+  std::vector< latency_histogram > latencies( thread_count );
+  std::vector< std::chrono::nanoseconds > ends( thread_count );
+
+  std::atomic< std::size_t > ready( 0 );
+  std::atomic< bool > go( false );
+  std::chrono::nanoseconds start;
+  
+  std::vector< std::thread > threads;
+  threads.reserve( thread_count );
+
+  for ( std::size_t t( 0 ); t != thread_count; ++t )
+    threads.emplace_back
+      ( [ & ]( std::size_t index ) -> void
+        {
+          if ( !cpus.empty() )
+            pin_current_thread( cpus[ index % cpus.size() ] );
+
+          latency_histogram& histogram( latencies[ index ] );
+          std::size_t hits( 0 );
+
+          ++ready;
+          while ( !go.load() )
+            ;
+
+          // The lookups are dealt to the threads in turn, such that each
+          // thread issues them at thread_count times the interval.
+          for ( std::size_t i( index ); i < g_open_loop_requests;
+                i += thread_count )
+            {
+              const std::chrono::nanoseconds intended
+                ( start + std::chrono::nanoseconds
+                  ( std::uint64_t( i * interval ) ) );
+
+              while ( now() < intended )
+                ;
+
+              hits += f( stream[ i % count ] );
+              histogram.record( ( now() - intended ).count() );
+            }
+
+          ends[ index ] = now();
+          do_not_optimize_away( hits );
+        },
+        t );
+
+  while ( ready.load() != thread_count )
+    std::this_thread::yield();
+
+  start = now();
+  go.store( true );
+  
+  for ( std::thread& t : threads )
+    t.join();
+
+  for ( std::size_t t( 1 ); t != thread_count; ++t )
+    latencies[ 0 ].merge( latencies[ t ] );
+
+  const double duration
+    ( std::max< std::int64_t >
+      ( 1,
+        ( *std::max_element( ends.begin(), ends.end() ) - start ).count() ) );
+
+  return open_loop_point
+    {
+      qps,
+      g_open_loop_requests * 1e9 / duration,
+      summarize_latency( latencies[ 0 ] )
+    };
+}
+
+/**
+ * Runs the open loop test at increasing rates to find the knee of the
+ * latency curve: the highest rate at which the lookups keep up with the
+ * schedule, with a median latency below ten times the lowest one of the
+ * previous rates. The median is used rather than the tail, which is too
+ * sensitive to the interruptions of the thread to tell when the queue
+ * builds up. The sweep stops at the first rate past the knee.
+ */
+template< typename T, typename F >
+open_loop_result run_open_loop_sweep
+( const std::vector< T >& stream, F& f )
+{
+  open_loop_result result;
+  result.knee_qps = 0;
+  
+  double qps( g_open_loop_qps );
+  double base( std::numeric_limits< double >::max() );
+
+  for ( std::size_t i( 0 ); i != g_open_loop_steps;
+        ++i, qps *= g_open_loop_factor )
+    {
+      result.points.push_back( run_open_loop( stream, qps, f ) );
+
+      const open_loop_point& point( result.points.back() );
+      base = std::min( base, std::max( 1.0, point.latency.p50 ) );
+
+      if ( ( point.achieved_qps < 0.9 * point.target_qps )
+           || ( point.latency.p50 > 10 * base ) )
+        break;
+
+      result.knee_qps = point.target_qps;
+    }
+
+  return result;
+}
+
+/**
+ * Applies the operations of the workload to a structure via the given
+ * functions, timing each of them individually such that the slow ones
+ * remain visible, e.g. when a table is rehashed.
+ */
+template< typename T, typename Contains, typename Insert, typename Erase >
+update_result run_updates
+( const std::vector< T >& keys, const update_workload& updates,
+  Contains&& contains, Insert&& insert, Erase&& erase )
+{
+  std::vector< double > durations[ 3 ];
+  std::uint64_t total( 0 );
+  std::size_t hits( 0 );
+
+  for ( const update_operation& operation : updates.operations )
+    {
+      const T& key( keys[ operation.key ] );
+      const std::chrono::nanoseconds start( now() );
+
+      switch ( operation.kind )
+        {
+        case update_kind::contains:
+          hits += contains( key );
+          break;
+        case update_kind::insert:
+          insert( key );
+          break;
+        case update_kind::erase:
+          erase( key );
+          break;
+        }
+
+      const std::uint64_t duration( ( now() - start ).count() );
+      total += duration;
+      durations[ std::size_t( operation.kind ) ].push_back( duration );
+    }
+
+  update_result result;
+  result.operations_per_second =
+    updates.operations.size() * 1e9 / std::max< std::uint64_t >( 1, total );
+  result.contains = summarize_latency( durations[ 0 ] );
+  result.insert = summarize_latency( durations[ 1 ] );
+  result.erase = summarize_latency( durations[ 2 ] );
+  result.hits = hits;
+  result.spikes = 0;
+
+  for ( const std::vector< double >& d : durations )
+    if ( !d.empty() )
+      result.spikes +=
+        d.end()
+        - std::upper_bound( d.begin(), d.end(), 10 * percentile( d, 0.5 ) );
+
+  return result;
+}
+
+/**
+ * Looks up the queries of a log, in order. If there is no schedule, they are
+ * looked up once as fast as possible to compute the throughput, then once
+ * again timing each of them. Otherwise each query is looked up at the
+ * scheduled time, in nanoseconds since the beginning of the replay, and its
+ * latency includes the delay since this time.
+ */
+template< typename T, typename F >
+replay_result run_replay
+( const std::vector< T >& queries,
+  const std::vector< std::uint64_t >& schedule, F& f )
+{
+  const std::size_t count( queries.size() );
+  assert( schedule.empty() || ( schedule.size() == count ) );
+  
+  std::vector< double > latencies;
+  latencies.reserve( count );
+
+  std::size_t hits( 0 );
+  std::chrono::nanoseconds start( now() );
+  std::chrono::nanoseconds end;
+  
+  if ( schedule.empty() )
+    {
+      for ( const T& q : queries )
+        hits += f( q );
+
+      end = now();
+      do_not_optimize_away( hits );
+      hits = 0;
+      
+      for ( const T& q : queries )
+        {
+          const std::chrono::nanoseconds query_start( now() );
+          hits += f( q );
+          latencies.push_back( ( now() - query_start ).count() );
+        }
+    }
+  else
+    {
+      for ( std::size_t i( 0 ); i != count; ++i )
+        {
+          const std::chrono::nanoseconds intended
+            ( start + std::chrono::nanoseconds( schedule[ i ] ) );
+
+          while ( now() < intended )
+            ;
+          
+          hits += f( queries[ i ] );
+          latencies.push_back( ( now() - intended ).count() );
+        }
+
+      end = now();
+    }
+
+  replay_result result;
+  result.queries_per_second =
+    count * 1e9 / std::max< std::int64_t >( 1, ( end - start ).count() );
+  result.hit_rate = double( hits ) / count;
+  result.latency = summarize_latency( latencies );
+  
+  return result;
+}
+
+struct needle_set
+{
+  needle_arena forward;
+  needle_arena reverse;
+  std::vector< std::size_t > lengths;
+  std::vector< std::size_t > query_order;
+
+  /** Skewed needles with both hits and misses. */
+  needle_arena workload;
+
+  /** The needles of the prefix queries, empty to skip them. */
+  needle_arena prefixes;
+
+  /** The queries of a replayed log, empty if there is none. */
+  needle_arena replay;
+
+  /**
+   * The time at which each query of the log is issued, in nanoseconds since
+   * the first one. Empty to replay the log as fast as possible.
+   */
+  std::vector< std::uint64_t > replay_schedule;
+};
+
+template< typename T, typename F >
+engine_result measure
+( const std::vector< T >& needles, const needle_set& set, F& f )
+{
+  engine_result result;
+  result.per_length =
+    run_benchmark( needles, set.lengths, result.counters, f );
+
+  result.throughput = throughput_result();
+  result.throughput.counters.fill( -1 );
+  result.contended = result.throughput;
+  result.batched = result.throughput;
+  result.open_loop.knee_qps = 0;
+
+  if ( !set.query_order.empty() )
+    {
+      // The needles are walked in a shuffled order, such that consecutive
+      // lookups hit unrelated parts of the structure.
+      const std::vector< T > stream( make_stream( needles, set.query_order ) );
+      result.throughput = run_throughput( stream, f );
+
+      if ( g_scaling_threads != 0 )
+        result.scaling = run_scaling( stream, f );
+
+      if ( g_noisy_neighbors != 0 )
+        {
+          const cache_thrasher thrasher( g_noisy_neighbors );
+          result.contended = run_throughput( stream, f );
+        }
+
+      if ( g_open_loop_requests != 0 )
+        result.open_loop = run_open_loop_sweep( stream, f );
+    }
+
+  if ( ( g_cold_lookups == 0 ) || needles.empty() )
+    result.cold = latency_summary{ 0, 0, 0, 0, 0, 0 };
+  else
+    result.cold = run_cold( needles, f );
+
+  return result;
+}
+
+/**
+ * Measures the throughput of the lookups of the needles in the order of the
+ * throughput test, passed by batches of g_batch_size needles to
+ * f( const T* needles, std::size_t count ), which returns the number of
+ * needles found.
+ */
+template< typename T, typename F >
+throughput_result run_batches
+( const std::vector< T >& needles, const needle_set& set, F&& f )
+{
+  typedef std::pair< const T*, std::size_t > batch;
+  
+  assert( g_batch_size != 0 );
+
+  const std::vector< T > stream( make_stream( needles, set.query_order ) );
+  std::vector< batch > batches;
+
+  for ( std::size_t i( 0 ); i < stream.size(); i += g_batch_size )
+    batches.emplace_back
+      ( stream.data() + i, std::min( g_batch_size, stream.size() - i ) );
+
+  return run_throughput
+    ( batches, stream.size(),
+      [ &f ]( const batch& b ) -> std::size_t
+      {
+        return f( b.first, b.second );
+      } );
+}
+
+/**
+ * Runs all the lookup measurements with the given needles, converted into
+ * the type expected by f. The build and load fields of the result are left
+ * to the caller.
+ */
+template< typename T, typename F >
+bench_result measure
+( const std::vector< T >& forward, const std::vector< T >& reverse,
+  const std::vector< T >& workload, const std::vector< T >& replay,
+  const needle_set& needles, F&& f )
+{
+  bench_result result = bench_result();
+  result.forward = measure( forward, needles, f );
+  result.reverse = measure( reverse, needles, f );
+
+  if ( replay.empty() )
+    result.replay = replay_result();
+  else
+    result.replay = run_replay( replay, needles.replay_schedule, f );
+
+  if ( workload.empty() )
+    {
+      result.workload = throughput_result();
+      result.workload.counters.fill( -1 );
+    }
+  else
+    result.workload = run_throughput( workload, f );
+  
+  return result;
+}
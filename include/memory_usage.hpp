@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * The memory allocated by the process, as seen by a replacement of the
+ * global operator new and by the kernel.
+ */
+struct footprint
+{
+  /** The bytes allocated via operator new and not released yet. */
+  std::size_t allocated;
+
+  /** The resident set size of the process in bytes. */
+  std::size_t resident;
+
+  /** The highest value reached by allocated. */
+  std::size_t peak;
+};
+
+/**
+ * Tells if the allocations via operator new are counted on this platform.
+ */
+bool allocation_tracking_available();
+
+/** Returns the bytes allocated via operator new and not released yet. */
+std::size_t allocated_bytes();
+
+/**
+ * Counts memory obtained without operator new, e.g. mapped directly, as
+ * allocated bytes.
+ */
+void count_mapped_bytes( std::size_t bytes );
+void uncount_mapped_bytes( std::size_t bytes );
+
+/**
+ * Returns the highest value of allocated_bytes() since the last call to
+ * reset_peak_allocated_bytes().
+ */
+std::size_t peak_allocated_bytes();
+void reset_peak_allocated_bytes();
+
+/**
+ * Returns the resident set size of the process in bytes, or zero if it
+ * cannot be read.
+ */
+std::size_t resident_set_size();
+
+/**
+ * Measures the growth of the memory usage since its construction, and the
+ * peak of the allocations in the meantime. The
+ * memory released before the construction is handed back to the system
+ * first, such that the resident set size is as close as possible to the
+ * memory actually in use.
+ */
+class footprint_meter
+{
+public:
+  footprint_meter();
+
+  footprint get() const;
+
+private:
+  footprint m_initial;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * The finalizer of MurmurHash3, which spreads each bit of the value over
+ * all the bits of the result. The codes of the words are far from random,
+ * e.g. the letters are the same in all their highest bits, thus the
+ * structures picking bits of their hash mix them first.
+ */
+inline std::uint64_t mix_hash( std::uint64_t h )
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+
+  return h;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "word_view.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Needles packed one after the other in a single buffer, such that the
+ * lookups are not slowed down by the allocation of each needle.
+ */
+class needle_arena
+{
+public:
+  needle_arena() = default;
+  explicit needle_arena( const std::vector< std::string >& words );
+
+  bool empty() const;
+  std::size_t size() const;
+
+  word_view operator[]( std::size_t i ) const;
+
+private:
+  std::vector< char > m_letters;
+
+  /**
+   * The offset of each needle in m_letters, followed by the size of
+   * m_letters.
+   */
+  std::vector< std::size_t > m_offsets;
+};
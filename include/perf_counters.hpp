@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+/**
+ * Hardware performance counters of the calling thread, read via
+ * perf_event_open(2). Counters that cannot be opened, for example because
+ * of the kernel's perf_event_paranoid setting or on a platform other than
+ * Linux, are reported as unavailable and the others still work.
+ */
+class perf_counters
+{
+public:
+  enum counter
+    {
+      cycles,
+      instructions,
+      l1d_misses,
+      llc_misses,
+      dtlb_misses,
+      branch_misses,
+      counter_count
+    };
+
+  /** The counts of each counter, negative if the counter is unavailable. */
+  typedef std::array< double, counter_count > sample;
+  
+public:
+  perf_counters();
+  perf_counters( const perf_counters& ) = delete;
+  perf_counters& operator=( const perf_counters& ) = delete;
+  ~perf_counters();
+
+  bool available() const;
+  
+  void start();
+  sample stop();
+
+  static const char* name( counter c );
+  
+private:
+  std::array< int, counter_count > m_fd;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "huge_pages.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A minimal perfect hash function over a static set of 64-bit codes, in the
+ * style of PTHash, followed by the array of the codes in the order of their
+ * hash such that a lookup compares the code found at its position.
+ *
+ * The codes are split in partitions, built independently by several
+ * threads. In a partition, the keys are distributed in buckets of about
+ * pilot_bucket_size keys, then the buckets are processed from the largest
+ * to the smallest, searching for each of them a 16-bit pilot value which
+ * sends all its keys to free slots of a table slightly larger than the
+ * partition. The slots past the number of keys are remapped to the free
+ * slots below it. The pilots and the remapped slots take about 3 bits per
+ * key. A partition in which a bucket finds no pilot is built again with
+ * another seed, stored with it, such that the build time grows linearly
+ * with the number of codes.
+ *
+ * The whole structure is a single block of 64-bit words, written as is by
+ * save() and loaded back by read() or map().
+ */
+class perfect_hash
+{
+public:
+  perfect_hash();
+  perfect_hash( const perfect_hash& ) = delete;
+  perfect_hash& operator=( const perfect_hash& ) = delete;
+  ~perfect_hash();
+
+  /**
+   * Builds the function for the given codes, of which the duplicates are
+   * ignored, using the given number of threads.
+   */
+  void build( std::vector< std::uint64_t > codes, std::size_t threads );
+
+  /**
+   * Tells if the code is in the set, from the pilot of its bucket then the
+   * code at its slot, two dependent loads which miss the cache on large
+   * sets.
+   */
+  bool contains( std::uint64_t code ) const;
+
+  /** The number of distinct codes. */
+  std::size_t size() const;
+
+  /** The bytes of the structure. */
+  std::size_t memory_usage() const;
+
+  /** The bits per key used by the pilots and the remapped slots. */
+  double metadata_bits_per_key() const;
+
+  bool save( const std::string& path ) const;
+
+  /** Loads the structure written by save() in memory. */
+  bool read( const std::string& path );
+
+  /** Maps the structure written by save() from the file. */
+  bool map( const std::string& path );
+
+private:
+  struct header;
+  struct partition;
+
+  typedef
+  std::vector< std::uint64_t, huge_page_allocator< std::uint64_t > > image;
+
+private:
+  void clear();
+  bool attach( const std::uint64_t* words, std::size_t size );
+  bool build_with_seed
+  ( const std::vector< std::uint64_t >& codes, std::uint64_t seed,
+    std::size_t threads );
+
+private:
+  /** The structure, when built or read. */
+  image m_image;
+
+  /** The mapped file, when mapped. */
+  void* m_mapping;
+  std::size_t m_mapping_size;
+
+  /** The parts of the structure, in m_image or m_mapping. */
+  const header* m_header;
+  const partition* m_partitions;
+  const std::uint16_t* m_pilots;
+  const std::uint32_t* m_remap;
+  const std::uint64_t* m_codes;
+};
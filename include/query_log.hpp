@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/** How the queries of a log are issued. */
+enum class replay_timing
+{
+  /** Each query is issued as soon as the previous one is answered. */
+  as_fast_as_possible,
+
+  /** Each query is issued at its recorded time. */
+  recorded
+};
+
+/** The queries of a production log, in the order they were issued. */
+struct query_log
+{
+  std::vector< std::string > queries;
+
+  /**
+   * The time of each query in nanoseconds since the first one, empty if the
+   * log has no timestamps.
+   */
+  std::vector< std::uint64_t > times;
+};
+
+/**
+ * Reads a log made of one query per line, optionally preceded by its
+ * timestamp in seconds and a space, e.g. "1700000000.125 WORD". Either all
+ * the lines or none of them have a timestamp, and the timestamps do not
+ * decrease. Returns false after reporting the first invalid line on
+ * std::cerr.
+ */
+bool read_query_log( query_log& result, std::istream& input );
+
+bool parse_replay_timing( replay_timing& result, const char* name );
+const char* replay_timing_name( replay_timing timing );
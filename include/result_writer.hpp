@@ -0,0 +1,51 @@
+#pragma once
+
+#include "bench_result.hpp"
+#include "run_metadata.hpp"
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class output_format
+{
+  /**
+   * Tab separated lines tagged with the engine name, with the speed
+   * relative to the baseline per length, as expected by format-result.sh.
+   */
+  text,
+  
+  json,
+
+  /** One value per row, with the columns engine, direction, metric, length,
+      threads and value. */
+  csv
+};
+
+bool parse_output_format( output_format& result, const char* name );
+
+/** Prints the results of the engines as they are measured. */
+class result_writer
+{
+public:
+  virtual ~result_writer();
+
+  virtual void begin( const run_metadata& metadata ) = 0;
+
+  /** Prints the speed of the word encoders, before the engines. */
+  virtual void encoders( const std::vector< encoder_result >& results ) = 0;
+
+  /**
+   * Prints the result of an engine. The baseline is the result of the
+   * reference engine, to which the others are compared.
+   */
+  virtual void engine
+  ( const std::string& tag, const bench_result& baseline,
+    const bench_result& result ) = 0;
+  
+  virtual void end() = 0;
+};
+
+std::unique_ptr< result_writer > make_result_writer
+( output_format format, std::ostream& output );
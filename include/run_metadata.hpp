@@ -0,0 +1,67 @@
+#pragma once
+
+#include "huge_pages.hpp"
+#include "query_log.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/** The context of a benchmark run, to compare the results between runs. */
+struct run_metadata
+{
+  std::string compiler;
+  std::string flags;
+  std::string cpu_model;
+
+  /** The number of times each word is looked up in the per length test. */
+  std::size_t runs;
+  
+  std::size_t key_count;
+
+  /** A FNV-1a hash of the word list, to detect a change in the corpus. */
+  std::uint64_t corpus_hash;
+
+  std::uint32_t seed;
+  std::size_t throughput_queries;
+
+  /** The CPU to which the main thread is pinned, negative if it is not. */
+  int cpu;
+
+  huge_page_mode huge_pages;
+  
+  std::size_t threads;
+  std::size_t cold_lookups;
+  std::size_t noisy_neighbors;
+  std::size_t open_loop_requests;
+  std::size_t open_loop_threads;
+
+  /** The size in bytes of the cache evicted or thrashed. */
+  std::size_t last_level_cache;
+  std::size_t workload_queries;
+  std::size_t prefix_queries;
+  std::size_t batch_size;
+  double max_load_factor;
+  std::size_t update_operations;
+  std::size_t replay_queries;
+  replay_timing replay_mode;
+};
+
+std::string compiler_name();
+std::string compiler_flags();
+
+/** Returns the model of the CPU, or "unknown" if it cannot be read. */
+std::string cpu_model();
+
+/** Computes the FNV-1a hash of a word list, one word after the other. */
+class corpus_hasher
+{
+public:
+  corpus_hasher();
+
+  void add( const std::string& word );
+  std::uint64_t get() const;
+
+private:
+  std::uint64_t m_hash;
+};
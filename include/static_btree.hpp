@@ -0,0 +1,69 @@
+#pragma once
+
+#include "huge_pages.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * A static set of 64-bit codes in a B+ tree of nodes of 16 keys, in the
+ * style of the S+ trees: the nodes are not linked, the children of the
+ * node b of a layer are the nodes 17b to 17b + 16 of the layer below, the
+ * lowest one being the sorted codes.
+ *
+ * A node spans two cache lines and is searched without branches, by
+ * counting its keys lower than the code, in four AVX2 comparisons when the
+ * processor has them. Thus a lookup in n codes waits for memory about
+ * log17(n) times, against log2(n) times for a binary search.
+ *
+ * The set stays ordered, thus it also counts the codes lower than a given
+ * one, from which the codes in a range are counted.
+ */
+class static_btree
+{
+public:
+  static_btree();
+  static_btree( const static_btree& ) = delete;
+  static_btree& operator=( const static_btree& ) = delete;
+
+  /** Builds the set, of which the duplicates are ignored. */
+  void build( std::vector< std::uint64_t > codes );
+
+  bool contains( std::uint64_t code ) const;
+
+  /** The number of codes in the set lower than the given code. */
+  std::size_t rank( std::uint64_t code ) const;
+
+  /**
+   * Counts the given codes found in the set. The codes of a batch go down
+   * the tree in lockstep, such that their cache misses overlap.
+   */
+  std::size_t count( const std::uint64_t* codes, std::size_t n ) const;
+
+  std::size_t size() const;
+
+  /** The bytes of the nodes, with their padding. */
+  std::size_t memory_usage() const;
+
+private:
+  typedef
+  std::vector< std::uint64_t, huge_page_allocator< std::uint64_t > > storage;
+
+private:
+  storage m_storage;
+
+  /**
+   * The nodes in m_storage, aligned on a cache line, with the sign bit of
+   * the keys flipped such that they are compared as signed integers.
+   */
+  std::uint64_t* m_keys;
+
+  /** The position in m_keys of each layer, from the lowest one. */
+  std::vector< std::size_t > m_layers;
+
+  std::size_t m_size;
+
+  /** Tells if the nodes are searched with the AVX2 instructions. */
+  bool m_avx2;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/** The mean of a sample and how precise it is. */
+struct sample_summary
+{
+  double mean;
+  double stddev;
+
+  /** The half width of the 95% confidence interval of the mean. */
+  double ci;
+
+  /** The coefficient of variation, stddev / mean. */
+  double cv;
+};
+
+/** Computes the mean of the values and its confidence interval. */
+sample_summary summarize( const std::vector< double >& values );
+
+/**
+ * Returns the 97.5th percentile of the Student's t-distribution with the
+ * given degrees of freedom, used for a two-sided 95% confidence interval.
+ */
+double student_t_975( std::size_t degrees );
+
+/**
+ * Returns the value at the given quantile q in [0, 1] of a sorted sample,
+ * using the nearest-rank method.
+ */
+template< typename T >
+T percentile( const std::vector< T >& sorted, double q )
+{
+  assert( !sorted.empty() );
+  
+  const std::size_t count( sorted.size() );
+  const std::size_t rank( q * count );
+
+  return sorted[ ( rank < count ) ? rank : count - 1 ];
+}
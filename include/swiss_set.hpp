@@ -0,0 +1,86 @@
+#pragma once
+
+#include "huge_pages.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * The highest load factor of the swiss_set created by the engines, set
+ * from the options of the benchmark.
+ */
+extern double g_max_load_factor;
+
+/**
+ * An open addressing hash set in the style of Abseil's Swiss tables. The
+ * slots are split in groups of 16, each slot having a control byte holding
+ * the 7 lowest bits of the hash of its key, or a mark for the empty and the
+ * erased slots. A lookup compares the tag of its key with the 16 control
+ * bytes of a group in a single SSE2 instruction, then compares the keys of
+ * the matching slots only. The groups are probed in triangular order, from
+ * the one given by the highest bits of the hash, until one has an empty
+ * slot.
+ *
+ * The keys are stored in a flat array of slots, thus a lookup costs a cache
+ * miss for the control bytes and one for the keys. The table grows to keep
+ * the slots in use, including the erased ones, below the given load factor.
+ */
+template< typename Key, typename Hash >
+class swiss_set
+{
+public:
+  /** Creates an empty set, whose load factor must be in (0, 1). */
+  explicit swiss_set( double max_load_factor );
+
+  void clear();
+
+  /** Inserts the key, if it is not in the set yet. */
+  void insert( const Key& key );
+
+  /** Removes the key, if it is in the set. */
+  void erase( const Key& key );
+
+  bool contains( const Key& key ) const;
+
+  /**
+   * Counts the given keys found in the set. Their hashes are computed and
+   * their groups prefetched by batches, such that the cache misses of the
+   * lookups of a batch overlap.
+   */
+  std::size_t count( const Key* keys, std::size_t n ) const;
+
+  std::size_t size() const;
+
+  /** The bytes of the control bytes and of the slots. */
+  std::size_t memory_usage() const;
+
+private:
+  typedef std::vector< std::int8_t, huge_page_allocator< std::int8_t > >
+  control_vector;
+  typedef std::vector< Key, huge_page_allocator< Key > > slot_vector;
+
+private:
+  std::size_t locate( const Key& key, std::uint64_t hash ) const;
+  void place( const Key& key, std::uint64_t hash );
+  void rehash( std::size_t group_count );
+
+private:
+  double m_max_load_factor;
+
+  /** The number of groups minus one, which is a power of two minus one. */
+  std::size_t m_group_mask;
+
+  std::size_t m_size;
+
+  /** The slots which are not empty, i.e. the keys and the erased ones. */
+  std::size_t m_used;
+
+  /** The number of used slots from which the table is rehashed. */
+  std::size_t m_used_limit;
+
+  control_vector m_control;
+  slot_vector m_slots;
+};
+
+#include "detail/swiss_set.tpp"
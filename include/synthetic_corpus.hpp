@@ -0,0 +1,127 @@
+#pragma once
+
+#include "key_source.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct synthetic_options
+{
+  /**
+   * The number of keys to generate. Zero disables the generator. A few keys
+   * may be missing if the lengths do not allow enough distinct keys.
+   */
+  std::size_t keys;
+
+  /** The letters of the keys, those of the training words if empty. */
+  std::string alphabet;
+
+  /**
+   * The number of previous letters from which the next one is predicted.
+   * Higher orders reproduce longer parts of the training words, thus more
+   * shared prefixes.
+   */
+  std::size_t order;
+
+  /**
+   * The weight of a uniform distribution mixed with the model, in [0, 1].
+   * Higher values give more diverse keys, thus fewer shared prefixes.
+   */
+  double smoothing;
+
+  /**
+   * The range of the lengths of the keys. Within this range the lengths
+   * follow the model.
+   */
+  std::size_t min_length;
+  std::size_t max_length;
+};
+
+/**
+ * A letter-level Markov model of a word list: the probability of each
+ * letter, or of the end of the word, given the previous letters.
+ */
+class markov_model
+{
+public:
+  /**
+   * Trains the model on the words made only of letters from the given
+   * alphabet, or on all the words if the alphabet is empty, in which case
+   * the alphabet is made of the letters of the words.
+   */
+  markov_model
+  ( const std::vector< std::string >& words, const std::string& alphabet,
+    std::size_t order );
+
+  /** The letters of the model, in increasing order. */
+  const std::string& alphabet() const;
+
+  /** The length of the longest word used to train the model. */
+  std::size_t longest() const;
+
+  /** Tells if there is such a state, the states being numbered from zero. */
+  bool has_state( std::size_t state ) const;
+
+  /** The state of the model before the first letter of a word. */
+  std::size_t start() const;
+
+  /**
+   * The state of the model after the letter of the given index in the
+   * alphabet, from the given state.
+   */
+  std::size_t next( std::size_t state, std::size_t letter ) const;
+
+  /**
+   * Returns the probability of the end of the word, at index zero, then of
+   * each letter of the alphabet, in the given state.
+   */
+  const std::vector< double >& probabilities( std::size_t state ) const;
+
+private:
+  typedef std::unordered_map< std::string, std::size_t > context_map;
+  
+private:
+  std::string context( const std::string& prefix ) const;
+  std::size_t find_state
+  ( const context_map& contexts, std::string context ) const;
+
+private:
+  std::string m_alphabet;
+  std::size_t m_order;
+  std::size_t m_longest;
+  std::size_t m_start;
+
+  /**
+   * The probabilities of the next letter for each state. A state is a
+   * context seen in the training words, of at most m_order letters.
+   */
+  std::vector< std::vector< double > > m_probabilities;
+
+  /** The next state for each state and letter. */
+  std::vector< std::size_t > m_transitions;
+};
+
+/**
+ * A corpus of keys generated from a Markov model. The keys are produced in
+ * order by a depth first traversal of the tree of the prefixes, in which
+ * the number of keys to generate below a prefix is split across its
+ * children according to the model. Thus they are never stored.
+ */
+class synthetic_corpus:
+  public corpus
+{
+public:
+  synthetic_corpus
+  ( const std::vector< std::string >& training,
+    const synthetic_options& options, std::uint32_t seed );
+
+  std::unique_ptr< key_source > keys() const override;
+
+private:
+  markov_model m_model;
+  synthetic_options m_options;
+  std::uint32_t m_seed;
+};
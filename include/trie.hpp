@@ -1,5 +1,10 @@
 #pragma once
 
+#include "alphabet.hpp"
+#include "huge_pages.hpp"
+#include "word_view.hpp"
+
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -16,10 +21,35 @@ struct trie
   std::vector< trie* > children;
 };
 
-void insert( trie& t, const std::string& word );
-bool find( const trie& t, const std::string& word );
+void insert( trie& t, word_view word );
+bool find( const trie& t, word_view word );
+
+/**
+ * Removes the word from t, with the nodes which do not lead to another
+ * word. Returns false if the word was not in t.
+ */
+bool erase( trie& t, word_view word );
+
+/** The nodes of a trie in a contiguous buffer. */
+typedef std::vector< std::uint8_t, huge_page_allocator< std::uint8_t > >
+flat_trie;
 
-void flatify( std::vector< std::uint8_t >& nodes, const trie& t );
-bool find( const std::vector< std::uint8_t >& nodes, const std::string& word );
+/**
+ * Writes the nodes of t in a contiguous buffer. Each node has a mask with a
+ * bit per symbol of the alphabet, thus its width depends on the alphabet.
+ * Throws std::overflow_error if a child is too far from its parent to be
+ * addressed.
+ */
+template< typename Alphabet = uppercase_alphabet >
+void flatify( flat_trie& nodes, const trie& t );
+
+/**
+ * Tells if the word is in the nodes written by flatify() with the same
+ * alphabet, whose letters must be in the alphabet.
+ */
+template< typename Alphabet = uppercase_alphabet >
+bool find( const flat_trie& nodes, word_view word );
 
 void test_trie();
+
+#include "detail/trie.tpp"
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "needle_arena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class update_kind : std::uint8_t
+{
+  contains,
+  insert,
+  erase
+};
+
+struct update_options
+{
+  /** The number of generated operations. Zero disables the workload. */
+  std::size_t operations;
+
+  /**
+   * The proportions of insertions and removals among the operations, the
+   * others being lookups.
+   */
+  double insert_ratio;
+  double erase_ratio;
+};
+
+struct update_operation
+{
+  update_kind kind;
+
+  /** The index of the key of the operation in update_workload::keys. */
+  std::uint32_t key;
+};
+
+/**
+ * A sequence of lookups, insertions and removals applied to a dictionary
+ * built from the corpus. The keys are the words of the corpus followed by
+ * new words made of the same letters. A key is only inserted when it is
+ * absent from the dictionary and only erased when it is present.
+ */
+struct update_workload
+{
+  needle_arena keys;
+  std::vector< update_operation > operations;
+
+  /** The number of lookups which find their key. */
+  std::size_t expected_hits;
+};
+
+/**
+ * Generates the operations applied to a dictionary built from the given
+ * sorted words, as described by options.
+ */
+update_workload generate_updates
+( const std::vector< std::string >& words, const update_options& options,
+  std::uint32_t seed );
+
+/**
+ * Parses the proportions of lookups, insertions and removals from a string
+ * formatted as "contains:insert:erase", e.g. "80:10:10".
+ */
+bool parse_update_mix( update_options& result, const char* mix );
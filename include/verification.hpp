@@ -0,0 +1,52 @@
+#pragma once
+
+#include "key_source.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Generates needles around the given sorted words: prefixes, extensions,
+ * edits, reversed words and random strings. Most of them are not words,
+ * some are.
+ */
+std::vector< std::string > generate_probes
+( const std::vector< std::string >& words, std::size_t count,
+  std::uint32_t seed );
+
+/**
+ * Builds each of the given engines from the corpus, then checks that the
+ * engine finds every key, and that it agrees with the corpus on every probe
+ * it supports. The divergences are reported on std::cerr. Returns false if
+ * an engine diverges or fails to build.
+ */
+bool verify_engines
+( const std::vector< std::string >& engines, const corpus& c,
+  const std::vector< std::string >& probes );
+
+/**
+ * Generates a random sorted corpus with the edge cases of the structures:
+ * the empty string, single letters, long shared prefixes and nodes with
+ * every letter as a child. The words have at most max_length letters.
+ */
+std::vector< std::string > generate_fuzz_corpus
+( std::uint32_t seed, std::size_t max_length );
+
+/**
+ * Builds a perfect_hash over the given number of random codes, then checks
+ * that it finds each of them and none of as many other random codes.
+ * Returns false after printing the first error on std::cerr.
+ */
+bool verify_perfect_hash( std::size_t keys, std::uint32_t seed );
+
+/**
+ * Verifies the given engines, all of them if empty, on the given number of
+ * fuzzed corpora. Returns false on the first divergence, after printing
+ * the seed of the corpus. The perfect hash is also verified on millions of
+ * keys, far more than in the fuzzed corpora.
+ */
+bool fuzz_engines
+( const std::vector< std::string >& engines, std::size_t rounds,
+  std::uint32_t seed );
@@ -1,5 +1,374 @@
 #pragma once
 
+#include "alphabet.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <vector>
+
+/** The longest word whose code does not collide with another word. */
+constexpr std::size_t g_max_encoded_length( 12 );
+
+/** The longest word whose 128-bit code does not collide with another word. */
+constexpr std::size_t g_max_encoded_length_128( 25 );
 
+std::uint64_t encode_word( const char* word, std::size_t size );
 std::uint64_t encode_word( const std::string& word );
+
+/**
+ * The code of a word of up to g_max_encoded_length letters, whose order is
+ * the lexicographic order of the words, contrary to encode_word(). The
+ * 5-bit codes of the letters start from the highest bits, and the length
+ * of the word is in the four lowest bits.
+ */
+std::uint64_t encode_word_ordered( const char* word, std::size_t size );
+std::uint64_t encode_word_ordered( const std::string& word );
+
+/** The word of a code computed by encode_word_ordered(). */
+std::string decode_word( std::uint64_t code );
+
+/**
+ * The order preserving code of a word of up to
+ * alphabet_traits< Alphabet >::max_code_length() symbols of the given
+ * alphabet: the ranks of the symbols start from the highest bits, on
+ * alphabet_traits< Alphabet >::symbol_bits() bits each, and the length of
+ * the word is in the lowest bits. The length tells the missing symbols from
+ * the symbols of rank zero, thus no value is reserved in the ranks.
+ */
+template< typename Alphabet >
+std::uint64_t encode_symbols( const char* word, std::size_t size );
+
+/** The word of a code computed by encode_symbols(). */
+template< typename Alphabet >
+std::string decode_symbols( std::uint64_t code );
+
+/**
+ * Computes the lowest and the highest codes of the words starting with the
+ * given prefix, of at most g_max_encoded_length letters, as given by
+ * encode_word_ordered(). The codes of these words are all in this range,
+ * and no other.
+ */
+void ordered_prefix_range
+( const char* prefix, std::size_t size, std::uint64_t& first,
+  std::uint64_t& last );
+
+/**
+ * The code of a word of up to g_max_encoded_length_128 letters, made of
+ * the 5-bit codes of its letters like the 64-bit code.
+ */
+struct word_code_128
+{
+  std::uint64_t high;
+  std::uint64_t low;
+};
+
+inline bool operator==( const word_code_128& a, const word_code_128& b )
+{
+  return ( a.high == b.high ) && ( a.low == b.low );
+}
+
+inline bool operator!=( const word_code_128& a, const word_code_128& b )
+{
+  return !( a == b );
+}
+
+inline bool operator<( const word_code_128& a, const word_code_128& b )
+{
+  return ( a.high < b.high ) || ( ( a.high == b.high ) && ( a.low < b.low ) );
+}
+
+word_code_128 encode_word_128( const char* word, std::size_t size );
+
+/**
+ * The code of a word of any length: the 64-bit codes of its successive
+ * groups of g_max_encoded_length letters. Since no letter is coded by zero,
+ * the last group, which may be shorter, does not collide with a full one.
+ *
+ * The code takes two 64-bit words, like word_code_128, such that the codes
+ * of the words of up to 24 letters are compared and hashed in place. The
+ * missing groups of these codes are zero. The longer codes are allocated:
+ * the highest bit of the first word, which no group code uses, is set, the
+ * other bits being the number of groups, and the second word points to
+ * them.
+ */
+class multiword_code
+{
+public:
+  static constexpr std::size_t inline_capacity = 2;
+
+public:
+  /** The code of the empty word. */
+  multiword_code();
+
+  /**
+   * A code of the given number of groups, to be filled via data() with
+   * non-zero values.
+   */
+  explicit multiword_code( std::size_t size );
+
+  multiword_code( const multiword_code& that );
+  multiword_code( multiword_code&& that ) noexcept;
+  ~multiword_code();
+
+  multiword_code& operator=( multiword_code that ) noexcept;
+
+  void swap( multiword_code& that ) noexcept;
+
+  bool allocated() const
+  {
+    return ( m_words[ 0 ] & allocated_bit ) != 0;
+  }
+
+  std::uint64_t* data()
+  {
+    return allocated() ? heap() : m_words;
+  }
+
+  const std::uint64_t* data() const
+  {
+    return allocated() ? heap() : m_words;
+  }
+
+  std::size_t size() const
+  {
+    if ( allocated() )
+      return m_words[ 0 ] & ~allocated_bit;
+
+    return ( m_words[ 0 ] != 0 ) + ( m_words[ 1 ] != 0 );
+  }
+
+  /** Tells if the two codes are equal, when they are not allocated. */
+  bool same_inline_words( const multiword_code& that ) const
+  {
+    return ( m_words[ 0 ] == that.m_words[ 0 ] )
+      && ( m_words[ 1 ] == that.m_words[ 1 ] );
+  }
+
+  /**
+   * Compares the two codes, when they are not allocated. The missing groups
+   * being zero, a code is lower than the longer codes starting with it.
+   */
+  bool inline_words_less( const multiword_code& that ) const
+  {
+    return ( m_words[ 0 ] < that.m_words[ 0 ] )
+      || ( ( m_words[ 0 ] == that.m_words[ 0 ] )
+           && ( m_words[ 1 ] < that.m_words[ 1 ] ) );
+  }
+
+private:
+  static constexpr std::uint64_t allocated_bit = std::uint64_t( 1 ) << 63;
+
+private:
+  std::uint64_t* heap() const
+  {
+    return reinterpret_cast< std::uint64_t* >( m_words[ 1 ] );
+  }
+
+private:
+  std::uint64_t m_words[ 2 ];
+};
+
+inline bool operator==( const multiword_code& a, const multiword_code& b )
+{
+  if ( !a.allocated() && !b.allocated() )
+    return a.same_inline_words( b );
+
+  const std::size_t size( a.size() );
+
+  if ( size != b.size() )
+    return false;
+
+  const std::uint64_t* const p( a.data() );
+  const std::uint64_t* const q( b.data() );
+
+  for ( std::size_t i( 0 ); i != size; ++i )
+    if ( p[ i ] != q[ i ] )
+      return false;
+
+  return true;
+}
+
+inline bool operator!=( const multiword_code& a, const multiword_code& b )
+{
+  return !( a == b );
+}
+
+/** Compares the words one after the other, then the sizes. */
+inline bool operator<( const multiword_code& a, const multiword_code& b )
+{
+  if ( !a.allocated() && !b.allocated() )
+    return a.inline_words_less( b );
+
+  const std::uint64_t* const p( a.data() );
+  const std::uint64_t* const q( b.data() );
+  const std::size_t n( ( a.size() < b.size() ) ? a.size() : b.size() );
+
+  for ( std::size_t i( 0 ); i != n; ++i )
+    if ( p[ i ] != q[ i ] )
+      return p[ i ] < q[ i ];
+
+  return a.size() < b.size();
+}
+
+multiword_code encode_word_multiword( const char* word, std::size_t size );
+
+/**
+ * Computes the code of type Code of a word, for the engines which are
+ * templates on the code. Each specialization provides
+ * static Code encode( const char*, std::size_t ),
+ * static std::size_t max_length(), the length of the longest word whose
+ * code does not collide with another word, and the type alphabet of the
+ * symbols of the encodable words.
+ */
+template< typename Code >
+struct word_encoding;
+
+template<>
+struct word_encoding< std::uint64_t >
+{
+  typedef uppercase_alphabet alphabet;
+
+  static std::uint64_t encode( const char* word, std::size_t size )
+  {
+    return encode_word( word, size );
+  }
+
+  static std::size_t max_length()
+  {
+    return g_max_encoded_length;
+  }
+};
+
+template<>
+struct word_encoding< word_code_128 >
+{
+  typedef uppercase_alphabet alphabet;
+
+  static word_code_128 encode( const char* word, std::size_t size )
+  {
+    return encode_word_128( word, size );
+  }
+
+  static std::size_t max_length()
+  {
+    return g_max_encoded_length_128;
+  }
+};
+
+template<>
+struct word_encoding< multiword_code >
+{
+  typedef uppercase_alphabet alphabet;
+
+  static multiword_code encode( const char* word, std::size_t size )
+  {
+    return encode_word_multiword( word, size );
+  }
+
+  static std::size_t max_length()
+  {
+    return std::numeric_limits< std::size_t >::max();
+  }
+};
+
+/**
+ * The codes of encode_symbols(), for the engines which are templates on the
+ * encoding.
+ */
+template< typename Alphabet >
+struct alphabet_encoding
+{
+  typedef Alphabet alphabet;
+  
+  static std::uint64_t encode( const char* word, std::size_t size )
+  {
+    return encode_symbols< Alphabet >( word, size );
+  }
+
+  static std::size_t max_length()
+  {
+    return alphabet_traits< Alphabet >::max_code_length();
+  }
+};
+
+/**
+ * Hashes the codes longer than 64 bits. The codes of the words short enough
+ * for a 64-bit code are their own hash, like the 64-bit codes.
+ */
+struct word_code_hash
+{
+  std::size_t operator()( const word_code_128& code ) const noexcept
+  {
+    return ( code.high * 0x9e3779b97f4a7c15 ) ^ code.low;
+  }
+
+  std::size_t operator()( const multiword_code& code ) const noexcept
+  {
+    const std::uint64_t* const words( code.data() );
+    std::uint64_t result( 0 );
+
+    for ( std::size_t i( 0 ); i != code.size(); ++i )
+      result = ( result * 0x9e3779b97f4a7c15 ) ^ words[ i ];
+
+    return result;
+  }
+};
+
+/** The bytes allocated by a code outside of its object. */
+inline std::size_t code_heap_size( std::uint64_t )
+{
+  return 0;
+}
+
+inline std::size_t code_heap_size( const word_code_128& )
+{
+  return 0;
+}
+
+inline std::size_t code_heap_size( const multiword_code& code )
+{
+  if ( !code.allocated() )
+    return 0;
+
+  return code.size() * sizeof( std::uint64_t );
+}
+
+/**
+ * The order preserving 64-bit code, for the engines which are templates on
+ * the encoding as well as on the code.
+ */
+struct ordered_word_encoding
+{
+  typedef uppercase_alphabet alphabet;
+
+  static std::uint64_t encode( const char* word, std::size_t size )
+  {
+    return encode_word_ordered( word, size );
+  }
+
+  static std::size_t max_length()
+  {
+    return g_max_encoded_length;
+  }
+};
+
+/** Tells if the word contains only letters from 'A' to 'Z'. */
+bool is_uppercase_word( const std::string& word );
+
+/** Tells if encode_word() gives a code specific to this word. */
+bool is_encodable( const std::string& word );
+
+/**
+ * Tells if the code of type Code given by Encoding to the word is specific
+ * to this word.
+ */
+template< typename Code, typename Encoding = word_encoding< Code > >
+bool is_encodable( const std::string& word )
+{
+  return ( word.size() <= Encoding::max_length() )
+    && alphabet_contains< typename Encoding::alphabet >( word );
+}
+
+#include "detail/word_encoding.tpp"
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+/**
+ * A word whose letters are stored elsewhere, e.g. in a needle_arena or in a
+ * network buffer. The letters are not null-terminated.
+ */
+struct word_view
+{
+  word_view( const char* d, std::size_t s )
+    : data( d ),
+      size( s )
+  {
+
+  }
+
+  word_view( const char* s )
+    : data( s ),
+      size( std::strlen( s ) )
+  {
+
+  }
+  
+  word_view( const std::string& s )
+    : data( s.data() ),
+      size( s.size() )
+  {
+
+  }
+
+  const char* begin() const
+  {
+    return data;
+  }
+  
+  const char* end() const
+  {
+    return data + size;
+  }
+
+  std::string str() const
+  {
+    return std::string( data, size );
+  }
+  
+  const char* data;
+  std::size_t size;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** How the needles absent from the dictionary are generated. */
+enum class miss_kind
+{
+  /** Random letters, with the length distribution of the hits. */
+  random_letters,
+  
+  /** A word of the dictionary with a single letter inserted, removed or
+      replaced. */
+  near_miss,
+
+  /** A strict prefix of a word of the dictionary. */
+  prefix
+};
+
+enum class length_distribution
+{
+  /** The lengths are distributed as in the dictionary. */
+  corpus,
+
+  /** Every length in the allowed range is equally represented. */
+  uniform
+};
+
+struct workload_options
+{
+  /** The number of generated needles. Zero disables the workload. */
+  std::size_t queries;
+
+  /**
+   * The exponent s of the Zipf distribution of the hits: the word of rank k
+   * is picked with a probability proportional to 1 / k^s. Zero gives a
+   * uniform distribution.
+   */
+  double zipf_exponent;
+
+  /** The proportion of needles found in the dictionary, in [0, 1]. */
+  double hit_ratio;
+  
+  miss_kind misses;
+
+  /** The range of the lengths of the needles. */
+  std::size_t min_length;
+  std::size_t max_length;
+  length_distribution lengths;
+};
+
+/**
+ * Generates a stream of needles to look up in the given sorted dictionary,
+ * with a skewed popularity of the words and a mix of hits and misses as
+ * described by options.
+ */
+std::vector< std::string > generate_workload
+( const std::vector< std::string >& words, const workload_options& options,
+  std::uint32_t seed );
+
+/**
+ * Picks count words uniformly in the given dictionary and cuts each of them
+ * to a random length, at least one letter if the word is not empty, to
+ * build the needles of the prefix queries.
+ */
+std::vector< std::string > generate_prefixes
+( const std::vector< std::string >& words, std::size_t count,
+  std::uint32_t seed );
+
+bool parse_miss_kind( miss_kind& result, const char* name );
+bool parse_length_distribution( length_distribution& result, const char* name );
@@ -0,0 +1,304 @@
+#include "batch_encoding.hpp"
+#include "word_encoding.hpp"
+
+#include <cassert>
+#include <cstring>
+
+#if defined( __x86_64__ )
+  #define BATCH_ENCODING_X86 1
+  #include <immintrin.h>
+#else
+  #define BATCH_ENCODING_X86 0
+#endif
+
+static std::size_t encode_words_scalar
+( const word_view* words, std::size_t count, std::uint64_t* codes )
+{
+  std::size_t invalid( 0 );
+
+  for ( std::size_t i( 0 ); i != count; ++i )
+    {
+      const word_view& w( words[ i ] );
+      std::uint64_t code( 0 );
+      bool valid( w.size <= g_max_encoded_length );
+
+      for ( std::size_t j( 0 ); valid && ( j != w.size ); ++j )
+        {
+          const std::uint64_t index( (unsigned char)w.data[ j ] - 'A' + 1 );
+          valid = ( index >= 1 ) && ( index <= 26 );
+          code = ( code << 5 ) | index;
+        }
+
+      codes[ i ] = valid ? code : g_invalid_code;
+      invalid += !valid;
+    }
+
+  return invalid;
+}
+
+#if BATCH_ENCODING_X86
+
+/**
+ * The vector implementations load 16 bytes from the beginning of the word,
+ * which may go past its end. This is harmless unless the bytes are on the
+ * next page, which may not be mapped, in which case the word is copied in
+ * the given buffer.
+ */
+static const char* readable_letters( const word_view& word, char* buffer )
+{
+  static constexpr std::uintptr_t page_size( 4096 );
+
+  if ( ( std::uintptr_t( word.data ) % page_size ) <= page_size - 16 )
+    return word.data;
+
+  std::memset( buffer, 0, 16 );
+  std::memcpy( buffer, word.data, word.size );
+  return buffer;
+}
+
+/**
+ * Computes the code of a word of at most g_max_encoded_length letters in
+ * the 16 bytes of letters, the lanes from size being ignored. The letters
+ * are converted to their index, then reversed by a shuffle such that the
+ * last one is in the first lane, and packed by multiplying the adjacent
+ * lanes: 5 bits in bytes, 10 bits in 16-bit lanes, then 20 bits in 32-bit
+ * lanes. The code is made of the three lowest 32-bit lanes.
+ */
+__attribute__(( target( "sse4.1" ) ))
+static std::uint64_t encode_sse41
+( __m128i letters, std::size_t size, bool& valid )
+{
+  const __m128i lanes
+    ( _mm_setr_epi8( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 ) );
+  const __m128i offset( _mm_sub_epi8( letters, _mm_set1_epi8( 'A' ) ) );
+
+  // The lanes holding a letter must be in [0, 25] once offset.
+  const int in_range
+    ( _mm_movemask_epi8
+      ( _mm_cmpeq_epi8
+        ( _mm_min_epu8( offset, _mm_set1_epi8( 25 ) ), offset ) ) );
+  const int used( ( 1 << size ) - 1 );
+  valid = ( ( in_range & used ) == used );
+
+  // The lanes past the end get a negative index, for which the shuffle
+  // gives zero.
+  const __m128i reverse
+    ( _mm_sub_epi8( _mm_set1_epi8( char( size - 1 ) ), lanes ) );
+  const __m128i indices
+    ( _mm_shuffle_epi8
+      ( _mm_add_epi8( offset, _mm_set1_epi8( 1 ) ), reverse ) );
+
+  const __m128i pairs
+    ( _mm_maddubs_epi16( indices, _mm_set1_epi16( 0x2001 ) ) );
+  const __m128i quads
+    ( _mm_madd_epi16( pairs, _mm_set1_epi32( 0x04000001 ) ) );
+
+  const std::uint64_t low( _mm_cvtsi128_si64( quads ) );
+  const std::uint64_t high( std::uint32_t( _mm_extract_epi32( quads, 2 ) ) );
+
+  return ( low & 0xfffff ) | ( ( low >> 32 ) << 20 ) | ( high << 40 );
+}
+
+__attribute__(( target( "sse4.1" ) ))
+static std::size_t encode_words_sse41
+( const word_view* words, std::size_t count, std::uint64_t* codes )
+{
+  std::size_t invalid( 0 );
+  char buffer[ 16 ];
+
+  for ( std::size_t i( 0 ); i != count; ++i )
+    {
+      const word_view& w( words[ i ] );
+      bool valid( false );
+
+      if ( w.size <= g_max_encoded_length )
+        codes[ i ] =
+          encode_sse41
+          ( _mm_loadu_si128
+            ( (const __m128i*)readable_letters( w, buffer ) ),
+            w.size, valid );
+
+      if ( !valid )
+        {
+          codes[ i ] = g_invalid_code;
+          ++invalid;
+        }
+    }
+
+  return invalid;
+}
+
+/**
+ * Computes the codes of two words of at most g_max_encoded_length letters,
+ * one in each 128-bit lane of letters, as encode_sse41() does.
+ */
+__attribute__(( target( "avx2" ) ))
+static void encode_avx2
+( __m256i letters, std::size_t size_0, std::size_t size_1,
+  std::uint64_t& code_0, std::uint64_t& code_1, bool& valid_0,
+  bool& valid_1 )
+{
+  const __m256i lanes
+    ( _mm256_setr_epi8
+      ( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 ) );
+  const __m256i offset( _mm256_sub_epi8( letters, _mm256_set1_epi8( 'A' ) ) );
+
+  const std::uint32_t in_range
+    ( _mm256_movemask_epi8
+      ( _mm256_cmpeq_epi8
+        ( _mm256_min_epu8( offset, _mm256_set1_epi8( 25 ) ), offset ) ) );
+  const std::uint32_t used_0( ( 1u << size_0 ) - 1 );
+  const std::uint32_t used_1( ( 1u << size_1 ) - 1 );
+  valid_0 = ( ( in_range & used_0 ) == used_0 );
+  valid_1 = ( ( ( in_range >> 16 ) & used_1 ) == used_1 );
+
+  const __m256i last
+    ( _mm256_setr_m128i
+      ( _mm_set1_epi8( char( size_0 - 1 ) ),
+        _mm_set1_epi8( char( size_1 - 1 ) ) ) );
+  const __m256i indices
+    ( _mm256_shuffle_epi8
+      ( _mm256_add_epi8( offset, _mm256_set1_epi8( 1 ) ),
+        _mm256_sub_epi8( last, lanes ) ) );
+
+  const __m256i pairs
+    ( _mm256_maddubs_epi16( indices, _mm256_set1_epi16( 0x2001 ) ) );
+  const __m256i quads
+    ( _mm256_madd_epi16( pairs, _mm256_set1_epi32( 0x04000001 ) ) );
+
+  // The second 32-bit lane of each word is moved next to the 20 bits of
+  // the first one, for the two words at once.
+  const __m256i shifted( _mm256_srli_epi64( quads, 12 ) );
+  const __m256i combined
+    ( _mm256_or_si256
+      ( _mm256_and_si256( quads, _mm256_set1_epi64x( 0xfffff ) ),
+        _mm256_andnot_si256( _mm256_set1_epi64x( 0xfffff ), shifted ) ) );
+
+  code_0 =
+    _mm256_extract_epi64( combined, 0 )
+    | ( std::uint64_t( _mm256_extract_epi32( quads, 2 ) ) << 40 );
+  code_1 =
+    _mm256_extract_epi64( combined, 2 )
+    | ( std::uint64_t( _mm256_extract_epi32( quads, 6 ) ) << 40 );
+}
+
+__attribute__(( target( "avx2" ) ))
+static std::size_t encode_words_avx2
+( const word_view* words, std::size_t count, std::uint64_t* codes )
+{
+  std::size_t invalid( 0 );
+  char buffer_0[ 16 ];
+  char buffer_1[ 16 ];
+  std::size_t i( 0 );
+
+  for ( ; i + 1 < count; i += 2 )
+    {
+      const word_view& w_0( words[ i ] );
+      const word_view& w_1( words[ i + 1 ] );
+
+      if ( ( w_0.size > g_max_encoded_length )
+           || ( w_1.size > g_max_encoded_length ) )
+        {
+          invalid += encode_words_sse41( words + i, 2, codes + i );
+          continue;
+        }
+
+      bool valid_0;
+      bool valid_1;
+
+      encode_avx2
+        ( _mm256_loadu2_m128i
+          ( (const __m128i*)readable_letters( w_1, buffer_1 ),
+            (const __m128i*)readable_letters( w_0, buffer_0 ) ),
+          w_0.size, w_1.size, codes[ i ], codes[ i + 1 ], valid_0, valid_1 );
+
+      if ( !valid_0 )
+        {
+          codes[ i ] = g_invalid_code;
+          ++invalid;
+        }
+
+      if ( !valid_1 )
+        {
+          codes[ i + 1 ] = g_invalid_code;
+          ++invalid;
+        }
+    }
+
+  if ( i != count )
+    invalid += encode_words_sse41( words + i, count - i, codes + i );
+
+  return invalid;
+}
+
+#endif
+
+const char* word_encoder_name( word_encoder encoder )
+{
+  switch ( encoder )
+    {
+    case word_encoder::scalar:
+      return "scalar";
+    case word_encoder::sse41:
+      return "sse4.1";
+    case word_encoder::avx2:
+      return "avx2";
+    }
+
+  return "unknown";
+}
+
+bool word_encoder_supported( word_encoder encoder )
+{
+  switch ( encoder )
+    {
+    case word_encoder::scalar:
+      return true;
+#if BATCH_ENCODING_X86
+    case word_encoder::sse41:
+      return __builtin_cpu_supports( "sse4.1" );
+    case word_encoder::avx2:
+      return __builtin_cpu_supports( "avx2" );
+#endif
+    default:
+      return false;
+    }
+}
+
+word_encoder best_word_encoder()
+{
+  static const word_encoder result
+    ( word_encoder_supported( word_encoder::avx2 )
+      ? word_encoder::avx2
+      : word_encoder_supported( word_encoder::sse41 )
+      ? word_encoder::sse41
+      : word_encoder::scalar );
+
+  return result;
+}
+
+std::size_t encode_words
+( const word_view* words, std::size_t count, std::uint64_t* codes )
+{
+  return encode_words( best_word_encoder(), words, count, codes );
+}
+
+std::size_t encode_words
+( word_encoder encoder, const word_view* words, std::size_t count,
+  std::uint64_t* codes )
+{
+  assert( word_encoder_supported( encoder ) );
+
+  switch ( encoder )
+    {
+#if BATCH_ENCODING_X86
+    case word_encoder::sse41:
+      return encode_words_sse41( words, count, codes );
+    case word_encoder::avx2:
+      return encode_words_avx2( words, count, codes );
+#endif
+    default:
+      return encode_words_scalar( words, count, codes );
+    }
+}
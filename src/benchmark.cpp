@@ -1,382 +1,661 @@
-#include "boggox/dictionary.hpp"
-#include "marisa/trie.h"
-#include "trie.hpp"
-#include "word_encoding.hpp"
+#include "benchmark.hpp"
+
+#include "batch_encoding.hpp"
+#include "cache_pressure.hpp"
+#include "cpu_affinity.hpp"
+#include "engine.hpp"
+#include "huge_pages.hpp"
+#include "measure.hpp"
+#include "memory_usage.hpp"
+#include "query_log.hpp"
+#include "result_writer.hpp"
+#include "run_metadata.hpp"
+#include "swiss_set.hpp"
+#include "synthetic_corpus.hpp"
+#include "update_workload.hpp"
+#include "verification.hpp"
+#include "workload.hpp"
 
 #include <algorithm>
-#include <chrono>
+#include <cassert>
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
-#include <limits>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
 #include <unistd.h>
-#include <unordered_set>
 
-std::size_t g_runs( 1000 );
+class build_meter
+{
+public:
+  build_meter()
+    : m_start( now() )
+  {
+
+  }
 
-typedef std::array< std::uint64_t, 11 > time_per_length;
+  build_result get() const
+  {
+    return build_result{ std::uint64_t( ( now() - m_start ).count() ),
+        m_memory.get(), 0 };
+  }
+
+private:
+  // Declared first such that the memory is trimmed before the clock starts.
+  footprint_meter m_memory;
+  std::chrono::nanoseconds m_start;
+};
 
-struct dictionary
+/**
+ * A file created in the temporary directory and removed when this instance
+ * is destroyed.
+ */
+class temporary_file
 {
-  std::vector< std::string > words;
-  std::vector< std::size_t > lengths;
+public:
+  temporary_file()
+  {
+    const char* const directory( std::getenv( "TMPDIR" ) );
+    std::string path( ( directory == nullptr ) ? "/tmp" : directory );
+    path += "/bench.XXXXXX";
+
+    std::vector< char > buffer( path.begin(), path.end() );
+    buffer.push_back( 0 );
+    
+    const int fd( mkstemp( buffer.data() ) );
+
+    if ( fd != -1 )
+      {
+        close( fd );
+        m_path = buffer.data();
+      }
+  }
+
+  temporary_file( const temporary_file& ) = delete;
+  temporary_file& operator=( const temporary_file& ) = delete;
+
+  ~temporary_file()
+  {
+    if ( !m_path.empty() )
+      std::remove( m_path.c_str() );
+  }
+
+  /** The path to the file, empty if it could not be created. */
+  const std::string& path() const
+  {
+    return m_path;
+  }
+
+private:
+  std::string m_path;
 };
 
-std::chrono::nanoseconds now()
+std::size_t file_size( const std::string& path )
 {
-  return
-    std::chrono::duration_cast< std::chrono::nanoseconds >
-    ( std::chrono::steady_clock::now().time_since_epoch() );
+  std::ifstream f( path, std::ios::binary | std::ios::ate );
+  return f ? std::size_t( f.tellg() ) : 0;
 }
 
-template <class T>
-void do_not_optimize_away(T&& datum)
+/**
+ * Builds a sequence of count indices in [0, word_count), made of
+ * consecutive shuffled permutations of the whole range, such that no needle
+ * is repeated until all the others have been looked up.
+ */
+std::vector< std::size_t > make_query_order
+( std::size_t word_count, std::size_t count, std::uint32_t seed )
 {
-  if (getpid() == 1)
+  std::vector< std::size_t > result;
+
+  if ( word_count == 0 )
+    return result;
+  
+  result.reserve( count + word_count );
+
+  std::vector< std::size_t > permutation( word_count );
+  std::iota( permutation.begin(), permutation.end(), 0 );
+  
+  std::mt19937 random( seed );
+  
+  while ( result.size() < count )
     {
-      const void* p = &datum;
-      putchar(*static_cast<const char*>(p));
+      std::shuffle( permutation.begin(), permutation.end(), random );
+      result.insert( result.end(), permutation.begin(), permutation.end() );
     }
+
+  result.resize( count );
+  return result;
 }
 
-template< typename T, typename F >
-time_per_length run_benchmark
-( const std::vector< T >& words, const std::vector< std::size_t >& length,
-  F&& f )
+/**
+ * Returns the number of keys for which the engine gives a wrong answer.
+ */
+std::size_t count_errors( const engine& e, const corpus& c )
 {
-  const std::size_t count( words.size() );
-  assert( count == length.size() );
-  
-  std::array
-    <
-      std::vector< time_per_length::value_type >,
-      11
-    > durations;
-  
-  for ( std::size_t i( 0 ); i != count; ++i )
-    {
-      const std::chrono::nanoseconds start( now() );
+  const std::unique_ptr< key_source > keys( c.keys() );
+  std::size_t result( 0 );
+  std::string key;
 
-      for ( std::size_t i( 0 ); i != g_runs; ++i )
-        do_not_optimize_away( f( words[ i ] ) );
-      
-      durations[ length[ i ] ].push_back( ( now() - start ).count() );
-    }
+  while ( keys->next( key ) )
+    if ( !e.contains( key ) )
+      ++result;
 
-  time_per_length result;
+  return result;
+}
 
-  for ( std::size_t i( 0 ); i != durations.size(); ++i )
-    if ( durations[ i ].empty() )
-      result[ i ] = 1;
-    else
+/**
+ * Saves the engine in a temporary file then measures how long it takes to
+ * load it back via each method it supports.
+ */
+std::vector< load_result > bench_load
+( const std::string& name, const engine& built, const corpus& c )
+{
+  std::vector< load_result > result;
+  const std::vector< std::string > methods( built.load_methods() );
+
+  if ( methods.empty() )
+    return result;
+
+  const temporary_file file;
+
+  if ( file.path().empty() || !built.save( file.path() ) )
     {
-      std::sort( durations[ i ].begin(), durations[ i ].end() );
-      result[ i ] = durations[ i ][ durations[ i ].size() / 2 ];
+      std::cerr << "Could not save " << name << ".\n";
+      return result;
     }
+
+  const std::size_t size( file_size( file.path() ) );
   
+  for ( const std::string& method : methods )
+    {
+      const std::unique_ptr< engine > loaded( engine_registry::create( name ) );
+      
+      const std::chrono::nanoseconds start( now() );
+      const bool success( loaded->load( file.path(), method ) );
+      const std::chrono::nanoseconds end( now() );
+
+      if ( !success )
+        std::cerr << "Could not load " << name << " via " << method << ".\n";
+      else if ( count_errors( *loaded, c ) != 0 )
+        std::cerr << name << " loaded via " << method
+                  << " does not find all the words.\n";
+      else
+        result.push_back
+          ( load_result
+            { method, std::uint64_t( ( end - start ).count() ), size } );
+    }
+
   return result;
 }
 
-struct bench_result
+bench_result bench_engine
+( const std::string& name, const corpus& c, const needle_set& needles,
+  const update_workload& updates )
 {
-  time_per_length forward;
-  time_per_length reverse;
-};
+  const std::unique_ptr< engine > e( engine_registry::create( name ) );
+  assert( e != nullptr );
 
-template< typename F >
-bench_result bench
-( const std::vector< std::string >& words,
-  const std::vector< std::string >& reversed_words,
-  const std::vector< std::size_t >& needle_lengths,
-  F&& f )
-{
-  return bench_result
+  const std::unique_ptr< key_source > keys( c.keys() );
+  
+  const build_meter meter;
+  e->build( *keys );
+  const build_result build( meter.get() );
+
+  bench_result result( e->measure( needles ) );
+
+  if ( needles.prefixes.empty()
+       || !e->measure_prefixes( needles.prefixes, result.prefixes ) )
     {
-      f( words, words, needle_lengths ),
-      f( words, reversed_words, needle_lengths )
-    };
-}
+      result.prefixes.throughput = throughput_result();
+      result.prefixes.throughput.counters.fill( -1 );
+      result.prefixes.hits = 0;
+    }
 
-time_per_length bench_binary_search
-( const std::vector< std::string >& words,
-  const std::vector< std::string >& needles,
-  const std::vector< std::size_t >& needle_lengths )
-{
-  const auto begin( words.begin() );
-  const auto end( words.end() );
+  if ( ( g_batch_size != 0 ) && !needles.query_order.empty() )
+    e->measure_batches( needles, result );
+  
+  result.build = build;
+  result.build.reported_size = e->memory_usage();
+  result.load = bench_load( name, *e, c );
+
+  // The updates are applied last since they modify the structure.
+  if ( !updates.operations.empty()
+       && e->measure_updates( updates, result.updates )
+       && ( result.updates.hits != updates.expected_hits ) )
+    {
+      std::cerr << name << " gives wrong answers after the updates.\n";
+      result.updates = update_result();
+    }
 
-  return run_benchmark
-    ( needles, needle_lengths,
-      [ & ]( const std::string& w ) -> bool
-      {
-        return std::binary_search( begin, end, w );
-      } );
+  return result;
 }
 
-std::vector< std::uint64_t > encode_words
-( const std::vector< std::string >& words )
+/**
+ * Measures the engine of the given name a second time with its structure on
+ * huge pages, if it supports them.
+ */
+void bench_huge_pages
+( result_writer& output, const std::string& name, const corpus& c,
+  const needle_set& needles, const update_workload& updates,
+  const bench_result& baseline )
 {
-  const std::size_t count( words.size() );
-  std::vector< std::uint64_t > result( count );
+  if ( !engine_registry::create( name )->uses_huge_pages() )
+    return;
 
-  for ( std::size_t i( 0 ); i != count; ++i )
-    result[ i ] = encode_word( words[ i ] );
+  g_huge_pages = true;
+  const bench_result result( bench_engine( name, c, needles, updates ) );
+  g_huge_pages = false;
 
-  return result;
+  output.engine( name + " [huge pages]", baseline, result );
 }
 
-time_per_length bench_binary_search_code
-( const std::vector< std::string >& words,
-  const std::vector< std::string >& needles,
-  const std::vector< std::size_t >& needle_lengths )
+void bench_all
+( result_writer& output, const corpus& c, const needle_set& needles,
+  const update_workload& updates, const std::vector< std::string >& engines,
+  const std::string& baseline_name, huge_page_mode huge_pages )
 {
-  const std::vector< std::uint64_t > coded_needles( encode_words( needles ) );
+  if ( !hardware_counters().available() )
+    std::cerr << "Hardware performance counters are unavailable, check"
+      " /proc/sys/kernel/perf_event_paranoid.\n";
 
-  std::vector< std::uint64_t > sorted( encode_words( words ) );
-  std::sort( sorted.begin(), sorted.end() );
+  const bench_result baseline
+    ( bench_engine( baseline_name, c, needles, updates ) );
+  output.engine( baseline_name, baseline, baseline );
 
-  const auto begin( sorted.begin() );
-  const auto end( sorted.end() );
+  for ( const std::string& name : engines )
+    {
+      if ( name != baseline_name )
+        output.engine
+          ( name, baseline, bench_engine( name, c, needles, updates ) );
 
-  return run_benchmark
-    ( coded_needles, needle_lengths,
-      [ & ]( std::uint64_t w ) -> bool
-      {
-        return std::binary_search( begin, end, w );
-      } );
+      if ( huge_pages == huge_page_mode::compare )
+        bench_huge_pages( output, name, c, needles, updates, baseline );
+    }
 }
 
-time_per_length bench_hash_set_code
-( const std::vector< std::string >& words,
-  const std::vector< std::string >& needles,
-  const std::vector< std::size_t >& needle_lengths )
+/** What is learnt from a single pass over the corpus. */
+struct corpus_summary
 {
-  std::unordered_set< std::uint64_t > set;
+  std::size_t key_count;
+  std::uint64_t hash;
 
-  for ( const std::string& w : words )
-    set.insert( encode_word( w ) );
-  
-  const std::vector< std::uint64_t > coded_needles( encode_words( needles ) );
-  const auto end( set.end() );
+  /** A sorted uniform sample of the keys, all of them if not sampled. */
+  std::vector< std::string > sample;
 
-  return run_benchmark
-    ( coded_needles, needle_lengths,
-      [ & ]( std::uint64_t w ) -> bool
-      {
-        return set.find( w ) != end;
-      } );
-}
+  /** For each scanned engine, tells if it supports all the keys. */
+  std::vector< bool > supported;
+};
 
-time_per_length bench_hash_set_code_direct
-( const std::vector< std::string >& words,
-  const std::vector< std::string >& needles,
-  const std::vector< std::size_t >& needle_lengths )
+/**
+ * Reads the corpus once to count and hash its keys, to check which of the
+ * given engines support them, and to keep at most sample_size keys, or all
+ * of them if sample_size is zero.
+ */
+corpus_summary scan_corpus
+( const corpus& c, const std::vector< std::unique_ptr< engine > >& engines,
+  std::size_t sample_size, std::uint32_t seed )
 {
-  struct hash
-  {
-    std::size_t operator()( std::uint64_t value ) const noexcept
+  corpus_summary result;
+  result.key_count = 0;
+  result.supported.assign( engines.size(), true );
+
+  corpus_hasher hasher;
+  std::mt19937_64 random( seed );
+  
+  const std::unique_ptr< key_source > keys( c.keys() );
+  std::string key;
+
+  while ( keys->next( key ) )
     {
-      return value;
+      hasher.add( key );
+
+      for ( std::size_t i( 0 ); i != engines.size(); ++i )
+        if ( result.supported[ i ] && !engines[ i ]->supports( key ) )
+          result.supported[ i ] = false;
+
+      // Reservoir sampling: the n-th key replaces a sampled one with a
+      // probability of sample_size / n.
+      if ( ( sample_size == 0 ) || ( result.sample.size() < sample_size ) )
+        result.sample.push_back( key );
+      else
+        {
+          const std::size_t i
+            ( std::uniform_int_distribution< std::size_t >
+              ( 0, result.key_count )( random ) );
+
+          if ( i < sample_size )
+            result.sample[ i ] = key;
+        }
+      
+      ++result.key_count;
     }
-  };
-    
-  std::unordered_set< std::uint64_t, hash > set;
 
-  for ( const std::string& w : words )
-    set.insert( encode_word( w ) );
-  
-  const std::vector< std::uint64_t > coded_needles( encode_words( needles ) );
-  const auto end( set.end() );
+  result.hash = hasher.get();
+  std::sort( result.sample.begin(), result.sample.end() );
 
-  return run_benchmark
-    ( coded_needles, needle_lengths,
-      [ & ]( std::uint64_t w ) -> bool
-      {
-        return set.find( w ) != end;
-      } );
+  return result;
 }
 
-time_per_length bench_hash_set
-( const std::vector< std::string >& words,
-  const std::vector< std::string >& needles,
-  const std::vector< std::size_t >& needle_lengths )
+/**
+ * Reads the query log to replay. Returns false if it cannot be read, or if
+ * it is to be replayed at its recorded timing but has no timestamps.
+ */
+static bool load_query_log( query_log& log, const benchmark_options& options )
 {
-  const std::unordered_set< std::string > set( words.begin(), words.end() );
+  std::ifstream f( options.replay );
 
-  const auto end( set.end() );
+  if ( !f )
+    {
+      std::cerr << "Could not open " << options.replay << ".\n";
+      return false;
+    }
+
+  if ( !read_query_log( log, f ) )
+    return false;
+
+  if ( log.queries.empty() )
+    {
+      std::cerr << "The query log is empty.\n";
+      return false;
+    }
   
-  return run_benchmark
-    ( needles, needle_lengths,
-      [ & ]( const std::string& w ) -> bool
-      {
-        return set.find( w ) != end;
-      } );
+  if ( ( options.replay_mode == replay_timing::recorded )
+       && log.times.empty() )
+    {
+      std::cerr << "The query log has no timestamps.\n";
+      return false;
+    }
+
+  return true;
 }
 
-bool contains
-( const boggox::dictionary& dictionary, const std::string& word )
+/**
+ * Measures each implementation of encode_words() supported by the CPU on
+ * the given needles, in the given number of passes after a warm-up pass.
+ */
+static std::vector< encoder_result > bench_encoders
+( const needle_arena& needles, std::size_t passes )
 {
-  const boggox::dictionary* d( &dictionary );
-  const auto end( word.end() );
+  std::vector< encoder_result > result;
+
+  if ( ( passes == 0 ) || needles.empty() )
+    return result;
+
+  std::vector< word_view > words;
+  words.reserve( needles.size() );
+
+  for ( std::size_t i( 0 ); i != needles.size(); ++i )
+    words.push_back( needles[ i ] );
+
+  std::vector< std::uint64_t > codes( words.size() );
   
-  for ( auto it( word.begin() ); it != end; ++it )
-    if ( d == nullptr )
-      return false;
-    else
-      d = d->suffixes( *it );
+  for ( word_encoder e
+          : { word_encoder::scalar, word_encoder::sse41, word_encoder::avx2 } )
+    {
+      if ( !word_encoder_supported( e ) )
+        continue;
+      
+      std::size_t invalid
+        ( encode_words( e, words.data(), words.size(), codes.data() ) );
+      std::vector< double > ns_per_word;
+
+      for ( std::size_t i( 0 ); i != passes; ++i )
+        {
+          const std::chrono::nanoseconds start( now() );
+          invalid = encode_words( e, words.data(), words.size(), codes.data() );
+          ns_per_word.push_back
+            ( double( ( now() - start ).count() ) / words.size() );
+          do_not_optimize_away( codes.back() );
+        }
+
+      const sample_summary summary( summarize( ns_per_word ) );
+      result.push_back
+        ( encoder_result
+          { word_encoder_name( e ), summary.mean, summary.ci, invalid } );
+    }
 
-  return ( d != nullptr ) && d->terminal();
+  return result;
 }
 
-time_per_length bench_boggox
-( const std::vector< std::string >& words,
-  const std::vector< std::string >& needles,
-  const std::vector< std::size_t >& needle_lengths )
+/**
+ * Pins the calling thread to the given CPU, which must be one of those
+ * available to the process. The available CPUs are queried before, such
+ * that the threads of the scaling test can still use them all.
+ */
+static bool pin_main_thread( int cpu )
 {
-  boggox::dictionary dictionary;
-  boggox::populate_dictionary( dictionary, words );
+  const std::vector< std::size_t > cpus( available_cpus() );
 
-  return run_benchmark
-    ( needles, needle_lengths,
-      [ & ]( const std::string& w ) -> bool
-      {
-        return contains( dictionary, w );
-      } );
+  if ( ( std::find( cpus.begin(), cpus.end(), std::size_t( cpu ) )
+         == cpus.end() )
+       || !pin_current_thread( cpu ) )
+    {
+      std::cerr << "Could not pin the thread to CPU " << cpu << ".\n";
+      return false;
+    }
+
+  return true;
 }
 
-time_per_length bench_marisa
-( const std::vector< std::string >& words,
-  const std::vector< std::string >& needles,
-  const std::vector< std::size_t >& needle_lengths )
+bool bench_all
+( std::ostream& output, const corpus& c, const benchmark_options& options )
 {
-  marisa::Keyset keys;
+  if ( ( options.cpu >= 0 ) && !pin_main_thread( options.cpu ) )
+    return false;
 
-  for ( const std::string& w : words )
-    keys.push_back( w.c_str() );
+  // In the comparison mode, the engines are switched to huge pages one at a
+  // time.
+  g_huge_pages = ( options.huge_pages == huge_page_mode::on );
   
-  marisa::Trie trie;
-  trie.build( keys );
+  std::vector< std::string > requested( options.engines );
 
-  marisa::Agent agent;
+  if ( requested.empty() )
+    requested = engine_registry::names();
+
+  // The baseline is scanned last, to check that it supports the corpus.
+  if ( !options.baseline.empty() )
+    requested.push_back( options.baseline );
   
-  return run_benchmark
-    ( needles, needle_lengths,
-      [ & ]( const std::string& w ) -> bool
-      {
-        agent.set_query( w.c_str() );
-        return trie.lookup( agent );
-      } );
-}
+  std::vector< std::unique_ptr< engine > > scanned;
+  
+  for ( const std::string& name : requested )
+    {
+      scanned.push_back( engine_registry::create( name ) );
+      
+      if ( scanned.back() == nullptr )
+        {
+          std::cerr << "Unknown engine: " << name << '\n';
+          return false;
+        }
+    }
 
-time_per_length bench_dynamic_trie
-( const std::vector< std::string >& words,
-  const std::vector< std::string >& needles,
-  const std::vector< std::size_t >& needle_lengths )
-{
-  trie t;
+  query_log log;
 
-  for ( const std::string& w : words )
-    insert( t, w );
+  if ( !options.replay.empty() && !load_query_log( log, options ) )
+    return false;
   
-  return run_benchmark
-    ( needles, needle_lengths,
-      [ & ]( const std::string& w ) -> bool
-      {
-        return find( t, w );
-      } );
-}
+  const corpus_summary summary
+    ( scan_corpus( c, scanned, options.sample, options.seed ) );
+  const std::vector< std::string >& words( summary.sample );
 
-time_per_length bench_static_trie
-( const std::vector< std::string >& words,
-  const std::vector< std::string >& needles,
-  const std::vector< std::size_t >& needle_lengths )
-{
-  trie t;
+  // The engines do not have to give a meaningful answer for the words they
+  // do not support, thus they must also support all the queries of the log.
+  std::vector< bool > replayable( scanned.size(), true );
 
-  for ( const std::string& w : words )
-    insert( t, w );
+  for ( std::size_t i( 0 ); i != scanned.size(); ++i )
+    {
+      vector_key_source queries( log.queries );
+      replayable[ i ] = supports_all( *scanned[ i ], queries );
+    }
+  
+  std::vector< std::string > engines;
+  const std::size_t engine_count
+    ( requested.size() - ( options.baseline.empty() ? 0 : 1 ) );
+  
+  for ( std::size_t i( 0 ); i != engine_count; ++i )
+    if ( !summary.supported[ i ] )
+      std::cerr << "Skipping " << requested[ i ]
+                << ", it does not support all the words of the corpus.\n";
+    else if ( !replayable[ i ] )
+      std::cerr << "Skipping " << requested[ i ]
+                << ", it does not support all the queries of the log.\n";
+    else
+      engines.push_back( requested[ i ] );
 
-  std::vector< std::uint8_t > nodes;
-  flatify( nodes, t );
+  if ( engines.empty() )
+    {
+      std::cerr << "No engine supports all the words of the corpus.\n";
+      return false;
+    }
+  
+  std::string baseline( options.baseline );
+
+  if ( baseline.empty() )
+    baseline =
+      ( std::find( engines.begin(), engines.end(), "bsearch-string" )
+        != engines.end() )
+      ? "bsearch-string" : engines.front();
+  else if ( !summary.supported.back() || !replayable.back() )
+    {
+      std::cerr << "The baseline " << baseline
+                << " does not support all the words of the corpus and of"
+        " the query log.\n";
+      return false;
+    }
+  
+  if ( options.probes != 0 )
+    {
+      std::vector< std::string > checked( engines );
+
+      if ( std::find( engines.begin(), engines.end(), baseline )
+           == engines.end() )
+        checked.push_back( baseline );
+
+      if ( !verify_engines
+           ( checked, c,
+             generate_probes( words, options.probes, options.seed ) ) )
+        {
+          std::cerr << "The engines do not agree with the reference.\n";
+          return false;
+        }
+    }
+  
+  needle_set needles;
+  std::vector< std::string > forward;
+  std::vector< std::string > reverse;
 
-  return run_benchmark
-    ( needles, needle_lengths,
-      [ & ]( const std::string& w ) -> bool
+  for ( const std::string& w : words )
+    if ( ( w.size() >= options.min_length )
+         && ( w.size() <= options.max_length ) )
       {
-        return find( nodes, w );
-      } );
-}
+        forward.push_back( w );
+        needles.lengths.push_back( w.size() );
+        reverse.emplace_back( w.rbegin(), w.rend() );
+      }
 
-void output_result
-( std::ostream& output, const std::string& tag, const bench_result& baseline,
-  const bench_result& result )
-{
-  for ( std::size_t length( 3 ); length <= 10; ++length )
-    output << length << '\t'
-           << (float)baseline.forward[ length ] / result.forward[ length ]
-           << '\t'
-           << (float)baseline.reverse[ length ] / result.reverse[ length ]
-           << '\t'
-           << "# " << tag << '\n';
-}
+  needles.forward = needle_arena( forward );
+  needles.reverse = needle_arena( reverse );
 
-void bench_all
-( std::ostream& output, const std::vector< std::string >& words,
-  const std::vector< std::string >& reversed_words,
-  const std::vector< std::size_t >& lengths )
-{
-  const bench_result baseline
-    ( bench( words, reversed_words, lengths, &bench_binary_search ) );
+  const std::size_t count( needles.forward.size() );
+
+  // The scaling mode walks the same stream than the throughput mode, thus we
+  // need at least one pass over the words.
+  const std::size_t queries
+    ( ( ( options.queries == 0 ) && ( options.threads != 0 ) )
+      ? count : options.queries );
   
-  output_result
-    ( output, "bsearch-string", baseline, baseline );
-  output_result
-    ( output, "bsearch-code", baseline,
-      bench( words, reversed_words, lengths, &bench_binary_search_code ) );
-  output_result
-    ( output, "hashset(code)", baseline,
-      bench( words, reversed_words, lengths, &bench_hash_set_code ) );
-  output_result
-    ( output, "hashset(code,hash)", baseline,
-      bench( words, reversed_words, lengths, &bench_hash_set_code_direct ) );
-  output_result
-    ( output, "hashset(string)", baseline,
-      bench( words, reversed_words, lengths, &bench_hash_set ) );
-  output_result
-    ( output, "array-trie", baseline,
-      bench( words, reversed_words, lengths, &bench_boggox ) );
-  output_result
-    ( output, "marisa", baseline,
-      bench( words, reversed_words, lengths, &bench_marisa ) );
-  output_result
-    ( output, "dynamic-trie", baseline,
-      bench( words, reversed_words, lengths, &bench_dynamic_trie ) );
-  output_result
-    ( output, "static-trie", baseline,
-      bench( words, reversed_words, lengths, &bench_static_trie ) );
-}
+  needles.query_order = make_query_order( count, queries, options.seed );
 
-void bench_all
-( std::ostream& output, const std::vector< std::string >& words )
-{
-  const std::size_t count( words.size() );
+  // When the corpus is sampled, the misses of the workload are only checked
+  // against the sample, thus a few of them may be hits.
+  needles.workload =
+    needle_arena
+    ( generate_workload( words, options.workload, options.seed ) );
 
-  std::vector< std::string > reversed_words;
-  reversed_words.reserve( count );
-  
-  std::vector< std::size_t > lengths;
-  lengths.reserve( count );
+  needles.prefixes =
+    needle_arena
+    ( generate_prefixes( words, options.prefix_queries, options.seed ) );
+
+  // Contrary to the workload, the new words of the updates must not be in
+  // the corpus, otherwise the engines would not find the expected hits.
+  update_options update_mix( options.updates );
 
-  for ( std::size_t i( 0 ); i != count; ++i )
+  if ( ( update_mix.operations != 0 )
+       && ( words.size() != summary.key_count ) )
     {
-      const std::string& w( words[ i ] );
-      lengths.emplace_back( w.size() );
-      reversed_words.emplace_back( w.rbegin(), w.rend() );
+      std::cerr << "The updates are not measured on a sampled corpus.\n";
+      update_mix.operations = 0;
     }
+  
+  const update_workload updates
+    ( generate_updates( words, update_mix, options.seed ) );
 
-  bench_all( output, words, reversed_words, lengths );
+  needles.replay = needle_arena( log.queries );
+
+  if ( options.replay_mode == replay_timing::recorded )
+    for ( std::uint64_t t : log.times )
+      needles.replay_schedule.push_back( t / options.replay_speed );
+  
+  g_scaling_threads = options.threads;
+  g_cold_lookups = options.cold_lookups;
+  g_noisy_neighbors = options.noisy_neighbors;
+  g_open_loop_requests = options.open_loop_requests;
+  g_open_loop_qps = options.open_loop_qps;
+  g_open_loop_factor = options.open_loop_factor;
+  g_open_loop_steps = options.open_loop_steps;
+  g_open_loop_threads = std::max< std::size_t >( 1, options.open_loop_threads );
+  g_runs = options.runs;
+  g_target_ci = options.target_ci;
+  g_min_batches = std::max< std::size_t >( 1, options.min_batches );
+  g_max_batches = std::max( g_min_batches, options.max_batches );
+  g_noise_cv = options.noise_cv;
+  g_batch_size = options.batch_size;
+  g_max_load_factor = options.max_load_factor;
+  g_bucket_width = std::max< std::size_t >( 1, options.bucket_width );
+  g_bucket_limit = options.bucket_limit;
+
+  run_metadata metadata;
+  metadata.compiler = compiler_name();
+  metadata.flags = compiler_flags();
+  metadata.cpu_model = cpu_model();
+  metadata.runs = g_runs;
+  metadata.key_count = summary.key_count;
+  metadata.corpus_hash = summary.hash;
+  metadata.seed = options.seed;
+  metadata.throughput_queries = needles.query_order.size();
+  metadata.cpu = options.cpu;
+  metadata.huge_pages = options.huge_pages;
+  metadata.threads = options.threads;
+  metadata.cold_lookups = options.cold_lookups;
+  metadata.noisy_neighbors = options.noisy_neighbors;
+  metadata.open_loop_requests = options.open_loop_requests;
+  metadata.open_loop_threads = g_open_loop_threads;
+  metadata.last_level_cache = last_level_cache_size();
+  metadata.workload_queries = needles.workload.size();
+  metadata.prefix_queries = needles.prefixes.size();
+  metadata.batch_size = options.batch_size;
+  metadata.max_load_factor = options.max_load_factor;
+  metadata.update_operations = updates.operations.size();
+  metadata.replay_queries = needles.replay.size();
+  metadata.replay_mode = options.replay_mode;
+  
+  const std::unique_ptr< result_writer > writer
+    ( make_result_writer( options.format, output ) );
+
+  writer->begin( metadata );
+  writer->encoders
+    ( bench_encoders( needles.forward, options.encoder_passes ) );
+  bench_all
+    ( *writer, c, needles, updates, engines, baseline, options.huge_pages );
+  writer->end();
+
+  return true;
 }
 
-void bench_all( std::ostream& output, std::istream& input )
+bool bench_all
+( std::ostream& output, std::istream& input,
+  const benchmark_options& options )
 {
   std::vector< std::string > words;
   std::string s;
@@ -384,6 +663,11 @@ void bench_all( std::ostream& output, std::istream& input )
   while ( input >> s )
     words.push_back( s );
 
+  if ( options.synthetic.keys != 0 )
+    return bench_all
+      ( output, synthetic_corpus( words, options.synthetic, options.seed ),
+        options );
+  
   assert( std::is_sorted( words.begin(), words.end() ) );
-  bench_all( output, words );
+  return bench_all( output, word_list_corpus( words ), options );
 }
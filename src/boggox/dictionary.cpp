@@ -1,44 +1,6 @@
 #include "boggox/dictionary.hpp"
 
-#include <algorithm>
 #include <fstream>
-#include <cassert>
-
-boggox::dictionary::dictionary()
-  : m_next( nullptr ),
-    m_terminal( false )
-{
-
-}
-
-boggox::dictionary::~dictionary()
-{
-  delete m_next;
-}
-    
-void boggox::dictionary::clear()
-{
-  delete m_next;
-  m_terminal = false;
-}
-    
-bool boggox::dictionary::terminal() const
-{
-  return m_terminal;
-}
-
-const boggox::dictionary* boggox::dictionary::suffixes( char key ) const
-{
-  if ( ( key < 'A' ) || ( 'Z' < key ) || ( m_next == nullptr ) )
-    return nullptr;
-
-  const boggox::dictionary* result( &(*m_next)[ key - 'A' ] );
-
-  if ( !result->m_terminal && ( result->m_next == nullptr ) )
-    return nullptr;
-  
-  return result;
-}      
 
 bool boggox::load_dictionary( dictionary& d, const char* filename )
 {
@@ -0,0 +1,104 @@
+#include "cache_pressure.hpp"
+
+#include "cpu_affinity.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#ifdef __linux__
+  #include <unistd.h>
+#endif
+
+/** The distance between two bytes read in distinct cache lines. */
+static constexpr std::size_t cache_line_size( 64 );
+
+std::size_t last_level_cache_size()
+{
+  long result( 0 );
+
+#if defined( __linux__ ) && defined( _SC_LEVEL3_CACHE_SIZE )
+  result = sysconf( _SC_LEVEL3_CACHE_SIZE );
+
+  if ( result <= 0 )
+    result = sysconf( _SC_LEVEL2_CACHE_SIZE );
+#endif
+
+  if ( result <= 0 )
+    return 32 * 1024 * 1024;
+
+  return result;
+}
+
+void evict_caches()
+{
+  static std::vector< std::uint8_t > buffer
+    ( 2 * last_level_cache_size(), 1 );
+  
+  std::uint8_t sum( 0 );
+
+  for ( std::size_t i( 0 ); i < buffer.size(); i += cache_line_size )
+    sum += buffer[ i ];
+
+  // Prevent the compiler from removing the loop.
+  buffer[ sum % cache_line_size ] = 1;
+}
+
+cache_thrasher::cache_thrasher( std::size_t thread_count )
+  : m_stop( false )
+{
+  const std::vector< std::size_t > cpus( available_cpus() );
+  std::vector< std::size_t > others;
+
+  for ( std::size_t cpu : cpus )
+    if ( cpu != current_cpu() )
+      others.push_back( cpu );
+  
+  std::atomic< std::size_t > ready( 0 );
+  m_threads.reserve( thread_count );
+  
+  for ( std::size_t t( 0 ); t != thread_count; ++t )
+    {
+      const bool pin( !others.empty() );
+      const std::size_t cpu( pin ? others[ t % others.size() ] : 0 );
+      
+      m_threads.emplace_back
+        ( [ this, pin, cpu, &ready ]() -> void
+          {
+            // The thread is pinned before allocating its buffer, such that
+            // the buffer is in the memory close to its CPU.
+            if ( pin )
+              pin_current_thread( cpu );
+
+            std::vector< std::uint8_t > buffer( last_level_cache_size() );
+            bool first( true );
+            
+            // The writes make the lines dirty, such that the caches also
+            // have to write them back when they evict them.
+            while ( !m_stop.load( std::memory_order_relaxed ) )
+              {
+                for ( std::size_t i( 0 ); i < buffer.size();
+                      i += cache_line_size )
+                  ++buffer[ i ];
+
+                if ( first )
+                  {
+                    first = false;
+                    ++ready;
+                  }
+              }
+          } );
+    }
+
+  // The measurements start once the buffers are allocated and in the
+  // cache.
+  while ( ready.load() != thread_count )
+    std::this_thread::yield();
+}
+
+cache_thrasher::~cache_thrasher()
+{
+  m_stop = true;
+
+  for ( std::thread& t : m_threads )
+    t.join();
+}
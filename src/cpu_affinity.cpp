@@ -0,0 +1,72 @@
+#include "cpu_affinity.hpp"
+
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+static std::vector< std::size_t > query_available_cpus()
+{
+  std::vector< std::size_t > result;
+  
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO( &set );
+  
+  if ( sched_getaffinity( 0, sizeof( set ), &set ) != 0 )
+    return result;
+
+  for ( std::size_t i( 0 ); i != CPU_SETSIZE; ++i )
+    if ( CPU_ISSET( i, &set ) )
+      result.push_back( i );
+#endif
+  
+  return result;
+}
+
+std::vector< std::size_t > available_cpus()
+{
+  static const std::vector< std::size_t > result( query_available_cpus() );
+  return result;
+}
+
+std::size_t current_cpu()
+{
+#ifdef __linux__
+  const int result( sched_getcpu() );
+
+  if ( result >= 0 )
+    return result;
+#endif
+
+  return 0;
+}
+
+std::uint64_t cpu_frequency( std::size_t cpu )
+{
+  std::ifstream f
+    ( "/sys/devices/system/cpu/cpu" + std::to_string( cpu )
+      + "/cpufreq/scaling_cur_freq" );
+  std::uint64_t result( 0 );
+
+  if ( !( f >> result ) )
+    return 0;
+
+  return result;
+}
+
+bool pin_current_thread( std::size_t cpu )
+{
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO( &set );
+  CPU_SET( cpu, &set );
+
+  return pthread_setaffinity_np( pthread_self(), sizeof( set ), &set ) == 0;
+#else
+  return false;
+#endif
+}
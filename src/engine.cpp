@@ -0,0 +1,111 @@
+#include "engine.hpp"
+
+#include <map>
+
+static std::map< std::string, engine_factory >& factories()
+{
+  // A function-level static such that it is initialized before the first
+  // registration, whatever the initialization order of the translation
+  // units.
+  static std::map< std::string, engine_factory > result;
+  return result;
+}
+
+engine::~engine() = default;
+
+bool engine::supports( const std::string& word ) const
+{
+  return true;
+}
+
+bool engine::count_prefix
+( const std::string& prefix, std::size_t& count ) const
+{
+  return false;
+}
+
+bool engine::measure_prefixes
+( const needle_arena& prefixes, prefix_result& result ) const
+{
+  return false;
+}
+
+bool engine::measure_batches
+( const needle_set& needles, bench_result& result ) const
+{
+  return false;
+}
+
+bool engine::measure_updates
+( const update_workload& updates, update_result& result )
+{
+  return false;
+}
+
+bool engine::save( const std::string& path ) const
+{
+  return false;
+}
+
+std::vector< std::string > engine::load_methods() const
+{
+  return std::vector< std::string >();
+}
+
+bool engine::load( const std::string& path, const std::string& method )
+{
+  return false;
+}
+
+bool engine::uses_huge_pages() const
+{
+  return false;
+}
+
+std::size_t engine::memory_usage() const
+{
+  return 0;
+}
+
+bool supports_all( const engine& e, key_source& keys )
+{
+  std::string key;
+
+  while ( keys.next( key ) )
+    if ( !e.supports( key ) )
+      return false;
+
+  return true;
+}
+
+void engine_registry::add
+( const std::string& name, const engine_factory& factory )
+{
+  factories()[ name ] = factory;
+}
+
+std::vector< std::string > engine_registry::names()
+{
+  std::vector< std::string > result;
+
+  for ( const auto& f : factories() )
+    result.push_back( f.first );
+
+  return result;
+}
+
+std::unique_ptr< engine > engine_registry::create( const std::string& name )
+{
+  const auto it( factories().find( name ) );
+
+  if ( it == factories().end() )
+    return nullptr;
+
+  return it->second();
+}
+
+engine_registration::engine_registration
+( const std::string& name, const engine_factory& factory )
+{
+  engine_registry::add( name, factory );
+}
@@ -0,0 +1,57 @@
+#include "engine.hpp"
+#include "word_encoding.hpp"
+
+#include "boggox/dictionary.hpp"
+
+namespace
+{
+  /** A trie whose nodes have a child for each symbol of Alphabet. */
+  template< typename Alphabet >
+  class array_trie:
+    public mutable_lookup_engine< array_trie< Alphabet >, word_view >
+  {
+  public:
+    static word_view prepare( word_view word )
+    {
+      return word;
+    }
+
+    bool supports( const std::string& word ) const override
+    {
+      return alphabet_contains< Alphabet >( word );
+    }
+
+    void build( key_source& keys ) override
+    {
+      m_dictionary.clear();
+
+      std::string key;
+
+      while ( keys.next( key ) )
+        m_dictionary.insert( key.begin(), key.end() );
+    }
+
+    bool lookup( word_view word ) const
+    {
+      return m_dictionary.contains( word.data, word.size );
+    }
+
+    void insert( word_view word )
+    {
+      m_dictionary.insert( word.begin(), word.end() );
+    }
+
+    void erase( word_view word )
+    {
+      m_dictionary.erase( word.data, word.size );
+    }
+
+  private:
+    boggox::basic_dictionary< Alphabet > m_dictionary;
+  };
+}
+
+static const register_engine< array_trie< uppercase_alphabet > >
+g_array_trie( "array-trie" );
+static const register_engine< array_trie< identifier_alphabet > >
+g_array_trie_identifier( "array-trie(identifier)" );
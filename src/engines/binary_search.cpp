@@ -0,0 +1,255 @@
+#include "engine.hpp"
+#include "word_encoding.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+  /** Compares the stored words with a needle without copying it. */
+  struct word_less
+  {
+    static int compare( const std::string& s, word_view w )
+    {
+      const int result
+        ( std::memcmp( s.data(), w.data, std::min( s.size(), w.size ) ) );
+
+      if ( result != 0 )
+        return result;
+
+      return ( s.size() < w.size ) ? -1 : ( s.size() > w.size );
+    }
+    
+    bool operator()( const std::string& s, word_view w ) const
+    {
+      return compare( s, w ) < 0;
+    }
+
+    bool operator()( word_view w, const std::string& s ) const
+    {
+      return compare( s, w ) > 0;
+    }
+  };
+  
+  /**
+   * Compares the stored words with a prefix, the words starting with it
+   * being equivalent to it.
+   */
+  struct prefix_less
+  {
+    static int compare( const std::string& s, word_view p )
+    {
+      const int result
+        ( std::memcmp( s.data(), p.data, std::min( s.size(), p.size ) ) );
+
+      if ( result != 0 )
+        return result;
+
+      return ( s.size() < p.size ) ? -1 : 0;
+    }
+    
+    bool operator()( const std::string& s, word_view p ) const
+    {
+      return compare( s, p ) < 0;
+    }
+
+    bool operator()( word_view p, const std::string& s ) const
+    {
+      return compare( s, p ) > 0;
+    }
+  };
+  
+  class binary_search_string:
+    public mutable_lookup_engine< binary_search_string, word_view >
+  {
+  public:
+    static word_view prepare( word_view word )
+    {
+      return word;
+    }
+    
+    void build( key_source& keys ) override
+    {
+      m_words.clear();
+
+      std::string key;
+
+      while ( keys.next( key ) )
+        m_words.push_back( key );
+      
+      std::sort( m_words.begin(), m_words.end() );
+    }
+
+    bool lookup( word_view word ) const
+    {
+      return std::binary_search
+        ( m_words.begin(), m_words.end(), word, word_less() );
+    }
+
+    /** Inserts the word at its position, moving the following ones. */
+    void insert( word_view word )
+    {
+      m_words.insert
+        ( std::lower_bound
+          ( m_words.begin(), m_words.end(), word, word_less() ),
+          word.str() );
+    }
+
+    void erase( word_view word )
+    {
+      m_words.erase
+        ( std::lower_bound
+          ( m_words.begin(), m_words.end(), word, word_less() ) );
+    }
+
+    bool count_prefix
+    ( const std::string& prefix, std::size_t& count ) const override
+    {
+      count = prefix_count( prefix );
+      return true;
+    }
+
+    bool measure_prefixes
+    ( const needle_arena& prefixes, prefix_result& result ) const override
+    {
+      std::vector< word_view > needles;
+      needles.reserve( prefixes.size() );
+
+      for ( std::size_t i( 0 ); i != prefixes.size(); ++i )
+        needles.push_back( prefixes[ i ] );
+
+      result.hits = 0;
+      
+      for ( word_view p : needles )
+        result.hits += prefix_count( p );
+      
+      result.throughput =
+        run_throughput
+        ( needles,
+          [ this ]( word_view p ) -> std::size_t
+          {
+            return prefix_count( p );
+          } );
+
+      return true;
+    }
+
+  private:
+    /** The words starting with the prefix, by string comparisons. */
+    std::size_t prefix_count( word_view prefix ) const
+    {
+      const auto range
+        ( std::equal_range
+          ( m_words.begin(), m_words.end(), prefix, prefix_less() ) );
+
+      return range.second - range.first;
+    }
+
+  private:
+    std::vector< std::string > m_words;
+  };
+
+  /**
+   * Looks up the codes of the words, of type Code, computed by Encoding, in
+   * a sorted array. See word_encoding for the available codes.
+   */
+  template< typename Code, typename Encoding = word_encoding< Code > >
+  class binary_search_code:
+    public mutable_lookup_engine< binary_search_code< Code, Encoding >, Code >
+  {
+  public:
+    static Code prepare( word_view word )
+    {
+      return Encoding::encode( word.data, word.size );
+    }
+
+    bool supports( const std::string& word ) const override
+    {
+      return is_encodable< Code, Encoding >( word );
+    }
+
+    void build( key_source& keys ) override
+    {
+      m_codes.clear();
+
+      std::string key;
+
+      while ( keys.next( key ) )
+        m_codes.push_back( prepare( key ) );
+      
+      std::sort( m_codes.begin(), m_codes.end() );
+    }
+
+    bool lookup( const Code& code ) const
+    {
+      return std::binary_search( m_codes.begin(), m_codes.end(), code );
+    }
+
+    void insert( const Code& code )
+    {
+      m_codes.insert
+        ( std::lower_bound( m_codes.begin(), m_codes.end(), code ), code );
+    }
+
+    void erase( const Code& code )
+    {
+      m_codes.erase
+        ( std::lower_bound( m_codes.begin(), m_codes.end(), code ) );
+    }
+
+    std::size_t memory_usage() const override
+    {
+      std::size_t result( m_codes.size() * sizeof( Code ) );
+
+      for ( const Code& code : m_codes )
+        result += code_heap_size( code );
+
+      return result;
+    }
+
+  protected:
+    std::vector< Code > m_codes;
+  };
+
+  /**
+   * Looks up the order preserving codes of the words in a sorted array,
+   * such that the words starting with a prefix are found by two binary
+   * searches on the integers.
+   */
+  class binary_search_ordered:
+    public ordered_prefix_engine
+    <
+      binary_search_ordered,
+      binary_search_code< std::uint64_t, ordered_word_encoding >
+    >
+  {
+  public:
+    std::size_t count_codes( std::uint64_t first, std::uint64_t last ) const
+    {
+      const auto begin
+        ( std::lower_bound( m_codes.begin(), m_codes.end(), first ) );
+      const auto end( std::upper_bound( begin, m_codes.end(), last ) );
+
+      return end - begin;
+    }
+  };
+}
+
+static const register_engine< binary_search_string >
+g_binary_search_string( "bsearch-string" );
+static const register_engine< binary_search_code< std::uint64_t > >
+g_binary_search_code( "bsearch-code" );
+static const register_engine< binary_search_ordered >
+g_binary_search_ordered( "bsearch-ordered" );
+static const register_engine< binary_search_code< word_code_128 > >
+g_binary_search_code_128( "bsearch-code128" );
+static const register_engine< binary_search_code< multiword_code > >
+g_binary_search_multiword( "bsearch-multiword" );
+static const register_engine
+<
+  binary_search_code
+  < std::uint64_t, alphabet_encoding< identifier_alphabet > >
+> g_binary_search_identifier( "bsearch-code(identifier)" );
+static const register_engine
+< binary_search_code< std::uint64_t, alphabet_encoding< byte_alphabet > > >
+g_binary_search_bytes( "bsearch-code(byte)" );
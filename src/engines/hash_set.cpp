@@ -0,0 +1,249 @@
+#include "batch_encoding.hpp"
+#include "engine.hpp"
+#include "huge_pages.hpp"
+#include "word_encoding.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace
+{
+  /** A hash function for the codes which are already well distributed. */
+  struct identity_hash
+  {
+    std::size_t operator()( std::uint64_t value ) const noexcept
+    {
+      return value;
+    }
+  };
+  
+  /**
+   * Stores the codes of the words, of type Code, computed by Encoding, in a
+   * hash set. See word_encoding for the available codes.
+   */
+  template
+  <
+    typename Code, typename Hash, typename Encoding = word_encoding< Code >
+  >
+  class hash_set_code:
+    public mutable_lookup_engine
+    < hash_set_code< Code, Hash, Encoding >, Code >
+  {
+  public:
+    static Code prepare( word_view word )
+    {
+      return Encoding::encode( word.data, word.size );
+    }
+
+    bool supports( const std::string& word ) const override
+    {
+      return is_encodable< Code, Encoding >( word );
+    }
+
+    void build( key_source& keys ) override
+    {
+      m_set.clear();
+
+      std::string key;
+
+      while ( keys.next( key ) )
+        m_set.insert( prepare( key ) );
+    }
+
+    bool lookup( const Code& code ) const
+    {
+      return m_set.find( code ) != m_set.end();
+    }
+
+    void insert( const Code& code )
+    {
+      m_set.insert( code );
+    }
+
+    void erase( const Code& code )
+    {
+      m_set.erase( code );
+    }
+
+    bool uses_huge_pages() const override
+    {
+      return true;
+    }
+
+  private:
+    /** Only the array of the buckets is large enough for huge pages. */
+    std::unordered_set
+    <
+      Code, Hash, std::equal_to< Code >, huge_page_allocator< Code >
+    > m_set;
+  };
+
+  /**
+   * Stores the 64-bit codes of the words in a hash set like hashset(code),
+   * but looks up the words themselves: their code is computed in the timed
+   * loops by the fastest implementation of encode_words(). The batches of
+   * needles are encoded in a single call before probing the set.
+   */
+  class hash_set_encode:
+    public mutable_lookup_engine< hash_set_encode, word_view >
+  {
+  public:
+    hash_set_encode()
+      : m_encoder( best_word_encoder() )
+    {
+
+    }
+    
+    static word_view prepare( word_view word )
+    {
+      return word;
+    }
+
+    bool supports( const std::string& word ) const override
+    {
+      return is_encodable( word );
+    }
+
+    void build( key_source& keys ) override
+    {
+      m_set.clear();
+
+      std::string key;
+
+      while ( keys.next( key ) )
+        m_set.insert( encode_word( key ) );
+    }
+
+    bool lookup( word_view word ) const
+    {
+      return m_set.find( encode( word ) ) != m_set.end();
+    }
+
+    std::size_t lookup_batch( const word_view* words, std::size_t count ) const
+    {
+      constexpr std::size_t chunk_size( 64 );
+      std::uint64_t codes[ chunk_size ];
+      std::size_t result( 0 );
+
+      for ( std::size_t first( 0 ); first < count; first += chunk_size )
+        {
+          const std::size_t n( std::min( count - first, chunk_size ) );
+          encode_words( m_encoder, words + first, n, codes );
+
+          // The invalid codes are not in the set.
+          for ( std::size_t i( 0 ); i != n; ++i )
+            result += ( m_set.find( codes[ i ] ) != m_set.end() );
+        }
+
+      return result;
+    }
+
+    void insert( word_view word )
+    {
+      m_set.insert( encode( word ) );
+    }
+
+    void erase( word_view word )
+    {
+      m_set.erase( encode( word ) );
+    }
+
+    bool measure_batches
+    ( const needle_set& needles, bench_result& result ) const override
+    {
+      this->measure_batch_lookups( needles, result );
+      return true;
+    }
+
+    bool uses_huge_pages() const override
+    {
+      return true;
+    }
+
+  private:
+    std::uint64_t encode( word_view word ) const
+    {
+      std::uint64_t result;
+      encode_words( m_encoder, &word, 1, &result );
+      return result;
+    }
+    
+  private:
+    const word_encoder m_encoder;
+    std::unordered_set
+    <
+      std::uint64_t, std::hash< std::uint64_t >,
+      std::equal_to< std::uint64_t >, huge_page_allocator< std::uint64_t >
+    > m_set;
+  };
+
+  class hash_set_string:
+    public mutable_lookup_engine< hash_set_string, std::string >
+  {
+  public:
+    /**
+     * std::unordered_set cannot look up anything but its key type, thus the
+     * needles are copied in strings out of the measured loops.
+     */
+    static std::string prepare( word_view word )
+    {
+      return word.str();
+    }
+
+    void build( key_source& keys ) override
+    {
+      m_set.clear();
+
+      std::string key;
+
+      while ( keys.next( key ) )
+        m_set.insert( key );
+    }
+
+    bool lookup( const std::string& word ) const
+    {
+      return m_set.find( word ) != m_set.end();
+    }
+
+    void insert( const std::string& word )
+    {
+      m_set.insert( word );
+    }
+
+    void erase( const std::string& word )
+    {
+      m_set.erase( word );
+    }
+
+    bool uses_huge_pages() const override
+    {
+      return true;
+    }
+
+  private:
+    std::unordered_set
+    <
+      std::string, std::hash< std::string >, std::equal_to< std::string >,
+      huge_page_allocator< std::string >
+    > m_set;
+  };
+}
+
+static const register_engine
+< hash_set_code< std::uint64_t, std::hash< std::uint64_t > > >
+g_hash_set_code( "hashset(code)" );
+static const register_engine< hash_set_code< std::uint64_t, identity_hash > >
+g_hash_set_code_direct( "hashset(code,hash)" );
+static const register_engine< hash_set_encode >
+g_hash_set_encode( "hashset(code,encode)" );
+static const register_engine< hash_set_code< word_code_128, word_code_hash > >
+g_hash_set_code_128( "hashset(code128)" );
+static const register_engine< hash_set_code< multiword_code, word_code_hash > >
+g_hash_set_multiword( "hashset(multiword)" );
+static const register_engine
+<
+  hash_set_code
+  < std::uint64_t, identity_hash, alphabet_encoding< identifier_alphabet > >
+> g_hash_set_identifier( "hashset(code,identifier)" );
+static const register_engine< hash_set_string >
+g_hash_set_string( "hashset(string)" );
@@ -0,0 +1,121 @@
+#include "engine.hpp"
+#include "huge_pages.hpp"
+
+#include "marisa/iostream.h"
+#include "marisa/trie.h"
+
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+  class marisa_trie:
+    public lookup_engine< marisa_trie, word_view >
+  {
+  public:
+    static word_view prepare( word_view word )
+    {
+      return word;
+    }
+
+    marisa_trie()
+      : m_huge_pages( g_huge_pages )
+    {
+
+    }
+
+    void build( key_source& keys ) override
+    {
+      marisa::Keyset keyset;
+      std::string key;
+
+      // The keyset copies the keys in its own storage.
+      while ( keys.next( key ) )
+        keyset.push_back( key.data(), key.size() );
+  
+      m_trie.build( keyset );
+
+      if ( m_huge_pages )
+        map_on_huge_pages();
+    }
+
+    bool lookup( word_view word ) const
+    {
+      // The agent holds the lookup state, thus each thread needs its own.
+      static thread_local marisa::Agent agent;
+      agent.set_query( word.data, word.size );
+      return m_trie.lookup( agent );
+    }
+
+    bool save( const std::string& path ) const override
+    {
+      try
+        {
+          m_trie.save( path.c_str() );
+          return true;
+        }
+      catch( const marisa::Exception& e )
+        {
+          std::cerr << "Could not save the marisa trie: " << e.what()
+                    << '\n';
+          return false;
+        }
+    }
+
+    std::vector< std::string > load_methods() const override
+    {
+      return std::vector< std::string >{ "read", "mmap" };
+    }
+    
+    bool load( const std::string& path, const std::string& method ) override
+    {
+      try
+        {
+          if ( method == "mmap" )
+            m_trie.mmap( path.c_str() );
+          else
+            m_trie.load( path.c_str() );
+
+          return true;
+        }
+      catch( const marisa::Exception& e )
+        {
+          std::cerr << "Could not load the marisa trie: " << e.what()
+                    << '\n';
+          return false;
+        }
+    }
+
+    bool uses_huge_pages() const override
+    {
+      return true;
+    }
+
+    std::size_t memory_usage() const override
+    {
+      return m_trie.total_size();
+    }
+
+  private:
+    /**
+     * marisa allocates its vectors via operator new[], thus the trie is
+     * serialized then mapped from a copy on huge pages instead.
+     */
+    void map_on_huge_pages()
+    {
+      std::ostringstream stream;
+      marisa::write( stream, m_trie );
+
+      const std::string image( stream.str() );
+      m_image.assign( image.begin(), image.end() );
+      m_trie.map( m_image.data(), m_image.size() );
+    }
+    
+  private:
+    const bool m_huge_pages;
+    std::vector< char, huge_page_allocator< char > > m_image;
+    marisa::Trie m_trie;
+  };
+}
+
+static const register_engine< marisa_trie > g_marisa( "marisa" );
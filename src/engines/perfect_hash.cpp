@@ -0,0 +1,88 @@
+#include "engine.hpp"
+#include "perfect_hash.hpp"
+#include "word_encoding.hpp"
+
+#include <thread>
+
+namespace
+{
+  /**
+   * Looks up the 64-bit codes of the words in a minimal perfect hash
+   * function followed by the array of the codes, built with a thread per
+   * core.
+   *
+   * The lookup does not wait for memory only once: it loads the partition,
+   * then the pilot of the bucket, then the code at the slot, each load
+   * depending on the previous one, plus the remapped slot for the last
+   * slots of the table, and it divides by the size of the table. The
+   * partitions are few and stay in the cache, but on large corpora both
+   * the pilot and the code miss it, thus this engine is slower than the
+   * hash sets whose lookup misses once.
+   */
+  class perfect_hash_code:
+    public lookup_engine< perfect_hash_code, std::uint64_t >
+  {
+  public:
+    static std::uint64_t prepare( word_view word )
+    {
+      return encode_word( word.data, word.size );
+    }
+
+    bool supports( const std::string& word ) const override
+    {
+      return is_encodable( word );
+    }
+
+    void build( key_source& keys ) override
+    {
+      std::vector< std::uint64_t > codes;
+      std::string key;
+
+      while ( keys.next( key ) )
+        codes.push_back( prepare( key ) );
+
+      m_hash.build
+        ( std::move( codes ),
+          std::max( 1u, std::thread::hardware_concurrency() ) );
+    }
+
+    bool lookup( std::uint64_t code ) const
+    {
+      return m_hash.contains( code );
+    }
+
+    bool save( const std::string& path ) const override
+    {
+      return m_hash.save( path );
+    }
+
+    std::vector< std::string > load_methods() const override
+    {
+      return std::vector< std::string >{ "read", "mmap" };
+    }
+
+    bool load( const std::string& path, const std::string& method ) override
+    {
+      if ( method == "mmap" )
+        return m_hash.map( path );
+
+      return m_hash.read( path );
+    }
+
+    bool uses_huge_pages() const override
+    {
+      return true;
+    }
+
+    std::size_t memory_usage() const override
+    {
+      return m_hash.memory_usage();
+    }
+
+  private:
+    perfect_hash m_hash;
+  };
+}
+
+static const register_engine< perfect_hash_code >
+g_perfect_hash_code( "mphf(code)" );
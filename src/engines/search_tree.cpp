@@ -0,0 +1,105 @@
+#include "engine.hpp"
+#include "eytzinger.hpp"
+#include "static_btree.hpp"
+#include "word_encoding.hpp"
+
+namespace
+{
+  /**
+   * Looks up the 64-bit codes of the words, computed by Encoding, in a
+   * static search tree laid out from the sorted codes, as an alternative to
+   * the binary search of the bsearch engines. Tree is eytzinger_array or
+   * static_btree.
+   */
+  template< typename Tree, typename Encoding = word_encoding< std::uint64_t > >
+  class search_tree_code:
+    public lookup_engine< search_tree_code< Tree, Encoding >, std::uint64_t >
+  {
+  public:
+    static std::uint64_t prepare( word_view word )
+    {
+      return Encoding::encode( word.data, word.size );
+    }
+
+    bool supports( const std::string& word ) const override
+    {
+      return is_encodable< std::uint64_t, Encoding >( word );
+    }
+
+    void build( key_source& keys ) override
+    {
+      std::vector< std::uint64_t > codes;
+      std::string key;
+
+      while ( keys.next( key ) )
+        codes.push_back( prepare( key ) );
+
+      m_tree.build( std::move( codes ) );
+    }
+
+    bool lookup( std::uint64_t code ) const
+    {
+      return m_tree.contains( code );
+    }
+
+    std::size_t
+    lookup_batch( const std::uint64_t* codes, std::size_t count ) const
+    {
+      return m_tree.count( codes, count );
+    }
+
+    bool measure_batches
+    ( const needle_set& needles, bench_result& result ) const override
+    {
+      this->measure_batch_lookups( needles, result );
+      return true;
+    }
+
+    bool uses_huge_pages() const override
+    {
+      return true;
+    }
+
+    std::size_t memory_usage() const override
+    {
+      return m_tree.memory_usage();
+    }
+
+  protected:
+    Tree m_tree;
+  };
+
+  /**
+   * Looks up the order preserving codes of the words in a static search
+   * tree, such that the words starting with a prefix are counted from the
+   * ranks of the bounds of the range of their codes.
+   */
+  template< typename Tree >
+  class search_tree_ordered:
+    public ordered_prefix_engine
+    <
+      search_tree_ordered< Tree >,
+      search_tree_code< Tree, ordered_word_encoding >
+    >
+  {
+  public:
+    std::size_t count_codes( std::uint64_t first, std::uint64_t last ) const
+    {
+      const std::size_t end
+        ( ( last == UINT64_MAX )
+          ? this->m_tree.size()
+          : this->m_tree.rank( last + 1 ) );
+
+      return end - this->m_tree.rank( first );
+    }
+  };
+}
+
+static const register_engine< search_tree_code< eytzinger_array > >
+g_eytzinger_code( "eytzinger(code)" );
+static const register_engine< search_tree_ordered< eytzinger_array > >
+g_eytzinger_ordered( "eytzinger(ordered)" );
+static const register_engine< search_tree_code< static_btree > >
+g_static_btree_code( "stree(code)" );
+static const register_engine< search_tree_ordered< static_btree > >
+g_static_btree_ordered( "stree(ordered)" );
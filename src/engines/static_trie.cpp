@@ -0,0 +1,129 @@
+#include "engine.hpp"
+
+#include "trie.hpp"
+#include "word_encoding.hpp"
+
+#include <fstream>
+
+namespace
+{
+  class dynamic_trie:
+    public mutable_lookup_engine< dynamic_trie, word_view >
+  {
+  public:
+    static word_view prepare( word_view word )
+    {
+      return word;
+    }
+
+    void build( key_source& keys ) override
+    {
+      std::string key;
+
+      while ( keys.next( key ) )
+        ::insert( m_trie, key );
+    }
+
+    bool lookup( word_view word ) const
+    {
+      return find( m_trie, word );
+    }
+
+    void insert( word_view word )
+    {
+      ::insert( m_trie, word );
+    }
+
+    void erase( word_view word )
+    {
+      ::erase( m_trie, word );
+    }
+
+  private:
+    trie m_trie;
+  };
+
+  /**
+   * The flat trie, in which the children of the nodes are indexed by their
+   * rank in Alphabet.
+   */
+  template< typename Alphabet >
+  class static_trie:
+    public lookup_engine< static_trie< Alphabet >, word_view >
+  {
+  public:
+    static word_view prepare( word_view word )
+    {
+      return word;
+    }
+
+    bool supports( const std::string& word ) const override
+    {
+      return alphabet_contains< Alphabet >( word );
+    }
+
+    void build( key_source& keys ) override
+    {
+      trie t;
+      std::string key;
+
+      while ( keys.next( key ) )
+        insert( t, key );
+
+      m_nodes.clear();
+      flatify< Alphabet >( m_nodes, t );
+    }
+
+    bool lookup( word_view word ) const
+    {
+      return find< Alphabet >( m_nodes, word );
+    }
+
+    bool save( const std::string& path ) const override
+    {
+      return bool
+        ( std::ofstream( path, std::ios::binary )
+          .write
+          ( reinterpret_cast< const char* >( m_nodes.data() ),
+            m_nodes.size() ) );
+    }
+
+    std::vector< std::string > load_methods() const override
+    {
+      return std::vector< std::string >{ "read" };
+    }
+    
+    bool load( const std::string& path, const std::string& method ) override
+    {
+      std::ifstream f( path, std::ios::binary | std::ios::ate );
+
+      if ( !f )
+        return false;
+      
+      m_nodes.resize( f.tellg() );
+      f.seekg( 0 );
+
+      return bool
+        ( f.read( reinterpret_cast< char* >( m_nodes.data() ), m_nodes.size() ) );
+    }
+
+    bool uses_huge_pages() const override
+    {
+      return true;
+    }
+
+    std::size_t memory_usage() const override
+    {
+      return m_nodes.size();
+    }
+
+  private:
+    flat_trie m_nodes;
+  };
+}
+
+static const register_engine< dynamic_trie > g_dynamic_trie( "dynamic-trie" );
+static const register_engine< static_trie< uppercase_alphabet > >
+g_static_trie( "static-trie" );
+static const register_engine< static_trie< identifier_alphabet > >
+g_static_trie_identifier( "static-trie(identifier)" );
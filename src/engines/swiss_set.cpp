@@ -0,0 +1,122 @@
+#include "engine.hpp"
+#include "inline_string.hpp"
+#include "swiss_set.hpp"
+#include "word_encoding.hpp"
+
+namespace
+{
+  /** A hash function for the 64-bit codes, whose bits are not random. */
+  struct mixed_hash
+  {
+    std::size_t operator()( std::uint64_t value ) const noexcept
+    {
+      return mix_hash( value );
+    }
+  };
+
+  /**
+   * Stores the needles of type Needle in a swiss_set, a flat open addressing
+   * table, as an alternative to the std::unordered_set of the hashset
+   * engines. Derived provides static Needle prepare( word_view ) and
+   * bool supports( const std::string& ) const.
+   */
+  template< typename Derived, typename Needle, typename Hash >
+  class swiss_set_engine:
+    public mutable_lookup_engine< Derived, Needle >
+  {
+  public:
+    swiss_set_engine()
+      : m_set( g_max_load_factor )
+    {
+
+    }
+
+    void build( key_source& keys ) override
+    {
+      m_set.clear();
+
+      std::string key;
+
+      while ( keys.next( key ) )
+        m_set.insert( Derived::prepare( key ) );
+    }
+
+    bool lookup( const Needle& needle ) const
+    {
+      return m_set.contains( needle );
+    }
+
+    std::size_t lookup_batch( const Needle* needles, std::size_t count ) const
+    {
+      return m_set.count( needles, count );
+    }
+
+    void insert( const Needle& needle )
+    {
+      m_set.insert( needle );
+    }
+
+    void erase( const Needle& needle )
+    {
+      m_set.erase( needle );
+    }
+
+    bool measure_batches
+    ( const needle_set& needles, bench_result& result ) const override
+    {
+      this->measure_batch_lookups( needles, result );
+      return true;
+    }
+
+    bool uses_huge_pages() const override
+    {
+      return true;
+    }
+
+    std::size_t memory_usage() const override
+    {
+      return m_set.memory_usage();
+    }
+
+  private:
+    swiss_set< Needle, Hash > m_set;
+  };
+
+  /** Stores the 64-bit codes of the words. */
+  class swiss_set_code:
+    public swiss_set_engine< swiss_set_code, std::uint64_t, mixed_hash >
+  {
+  public:
+    static std::uint64_t prepare( word_view word )
+    {
+      return encode_word( word.data, word.size );
+    }
+
+    bool supports( const std::string& word ) const override
+    {
+      return is_encodable( word );
+    }
+  };
+
+  /** Stores the words of at most inline_string::capacity bytes in place. */
+  class swiss_set_string:
+    public swiss_set_engine
+    < swiss_set_string, inline_string, inline_string_hash >
+  {
+  public:
+    static inline_string prepare( word_view word )
+    {
+      return inline_string( word.data, word.size );
+    }
+
+    bool supports( const std::string& word ) const override
+    {
+      return word.size() <= inline_string::capacity;
+    }
+  };
+}
+
+static const register_engine< swiss_set_code >
+g_swiss_set_code( "swisstable(code)" );
+static const register_engine< swiss_set_string >
+g_swiss_set_string( "swisstable(string)" );
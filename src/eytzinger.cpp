@@ -0,0 +1,198 @@
+#include "eytzinger.hpp"
+
+#include <algorithm>
+
+/** The number of 64-bit words in a cache line. */
+static constexpr std::size_t line_words( 8 );
+
+/**
+ * The number of levels walked while the descendants of a node are loaded,
+ * such that they fill two cache lines.
+ */
+static constexpr unsigned prefetch_depth( 4 );
+
+/** Puts the sorted codes in the subtree of the node k, in order. */
+static void fill_subtree
+( const std::uint64_t* codes, std::uint64_t* nodes, std::size_t size,
+  std::size_t& next, std::size_t k )
+{
+  if ( k > size )
+    return;
+
+  fill_subtree( codes, nodes, size, next, 2 * k );
+  nodes[ k ] = codes[ next ];
+  ++next;
+  fill_subtree( codes, nodes, size, next, 2 * k + 1 );
+}
+
+/**
+ * Walks from the node k of the last level, whose missing nodes are lower
+ * than any code, then goes back to the node of the lowest code not lower
+ * than the given one: the last node from which the walk went left. The
+ * result is zero if all the codes are lower.
+ */
+static std::size_t last_step
+( const std::uint64_t* nodes, std::size_t size, std::size_t k,
+  std::uint64_t code )
+{
+  k = 2 * k + ( ( k > size ) | ( nodes[ k ] < code ) );
+  return k >> __builtin_ffsll( ~k );
+}
+
+eytzinger_array::eytzinger_array()
+  : m_nodes( nullptr ),
+    m_size( 0 ),
+    m_depth( 0 )
+{
+  build( std::vector< std::uint64_t >() );
+}
+
+void eytzinger_array::build( std::vector< std::uint64_t > codes )
+{
+  std::sort( codes.begin(), codes.end() );
+  codes.erase( std::unique( codes.begin(), codes.end() ), codes.end() );
+
+  m_size = codes.size();
+  m_depth = ( m_size == 0 ) ? 0 : 63 - __builtin_clzll( m_size );
+
+  // The last level is complete, such that the last step of the walk reads
+  // its padding rather than checking the bounds.
+  const std::size_t node_count( std::size_t( 2 ) << m_depth );
+
+  storage nodes( node_count + line_words, 0, m_storage.get_allocator() );
+  m_storage.swap( nodes );
+
+  const std::uintptr_t address( std::uintptr_t( m_storage.data() ) );
+  const std::uintptr_t line_size( line_words * sizeof( std::uint64_t ) );
+  m_nodes =
+    m_storage.data()
+    + ( line_size - address % line_size ) % line_size
+    / sizeof( std::uint64_t );
+
+  std::size_t next( 0 );
+  fill_subtree( codes.data(), m_nodes, m_size, next, 1 );
+}
+
+bool eytzinger_array::contains( std::uint64_t code ) const
+{
+  const std::size_t k( lower_bound( code ) );
+  return ( k != 0 ) & ( m_nodes[ k ] == code );
+}
+
+std::size_t eytzinger_array::rank( std::uint64_t code ) const
+{
+  std::size_t k( lower_bound( code ) );
+
+  if ( k == 0 )
+    return m_size;
+
+  // The nodes before k in order are those of its left subtree, and for
+  // each ancestor it is right of, this ancestor and its left subtree.
+  unsigned height( m_depth - ( 63 - __builtin_clzll( k ) ) );
+  std::size_t result
+    ( ( 2 * k > m_size ) ? 0 : subtree_size( 2 * k, height - 1 ) );
+
+  for ( ; k > 1; k /= 2, ++height )
+    result += ( k & 1 ) * ( subtree_size( k - 1, height ) + 1 );
+
+  return result;
+}
+
+std::size_t
+eytzinger_array::count( const std::uint64_t* codes, std::size_t n ) const
+{
+  constexpr std::size_t batch_size( 16 );
+  std::size_t nodes[ batch_size ];
+  std::size_t result( 0 );
+
+  for ( std::size_t first( 0 ); first < n; first += batch_size )
+    {
+      const std::size_t count( std::min( n - first, batch_size ) );
+      const std::uint64_t* const batch( codes + first );
+
+      std::fill( nodes, nodes + count, 1 );
+
+      unsigned level( 0 );
+
+      for ( ; level + prefetch_depth < m_depth; ++level )
+        for ( std::size_t i( 0 ); i != count; ++i )
+          {
+            const std::size_t k( nodes[ i ] );
+            const std::uint64_t* const descendants
+              ( m_nodes + ( k << prefetch_depth ) );
+
+            __builtin_prefetch( descendants );
+            __builtin_prefetch( descendants + line_words );
+            nodes[ i ] = 2 * k + ( m_nodes[ k ] < batch[ i ] );
+          }
+
+      for ( ; level != m_depth; ++level )
+        for ( std::size_t i( 0 ); i != count; ++i )
+          {
+            const std::size_t k( nodes[ i ] );
+            nodes[ i ] = 2 * k + ( m_nodes[ k ] < batch[ i ] );
+          }
+
+      for ( std::size_t i( 0 ); i != count; ++i )
+        {
+          const std::size_t k
+            ( last_step( m_nodes, m_size, nodes[ i ], batch[ i ] ) );
+          result += ( k != 0 ) & ( m_nodes[ k ] == batch[ i ] );
+        }
+    }
+
+  return result;
+}
+
+std::size_t eytzinger_array::size() const
+{
+  return m_size;
+}
+
+std::size_t eytzinger_array::memory_usage() const
+{
+  return m_storage.size() * sizeof( std::uint64_t );
+}
+
+/**
+ * The index of the node of the lowest code not lower than the given one,
+ * or zero if there is none.
+ */
+std::size_t eytzinger_array::lower_bound( std::uint64_t code ) const
+{
+  std::size_t k( 1 );
+  unsigned level( 0 );
+
+  // The loads of a node's descendants are started before walking to them.
+  // They are within the array as long as prefetch_depth levels remain.
+  for ( ; level + prefetch_depth < m_depth; ++level )
+    {
+      const std::uint64_t* const descendants
+        ( m_nodes + ( k << prefetch_depth ) );
+
+      __builtin_prefetch( descendants );
+      __builtin_prefetch( descendants + line_words );
+      k = 2 * k + ( m_nodes[ k ] < code );
+    }
+
+  for ( ; level != m_depth; ++level )
+    k = 2 * k + ( m_nodes[ k ] < code );
+
+  return last_step( m_nodes, m_size, k, code );
+}
+
+/**
+ * The number of nodes in the subtree of the node k, which is in the tree
+ * and has the given number of levels below it.
+ */
+std::size_t
+eytzinger_array::subtree_size( std::size_t k, unsigned height ) const
+{
+  // The levels of the subtree above the last level of the tree are
+  // complete.
+  const std::size_t width( std::size_t( 1 ) << height );
+  const std::size_t first_leaf( k << height );
+
+  return width - 1
+    + std::min( width, m_size + 1 - std::min( m_size + 1, first_leaf ) );
+}
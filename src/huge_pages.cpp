@@ -0,0 +1,102 @@
+#include "huge_pages.hpp"
+
+#include "memory_usage.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+  #include <sys/mman.h>
+#endif
+
+bool g_huge_pages( false );
+
+static std::size_t round_to_huge_pages( std::size_t bytes )
+{
+  return ( bytes + huge_page_size - 1 ) / huge_page_size * huge_page_size;
+}
+
+void* allocate_huge_pages( std::size_t bytes )
+{
+  const std::size_t size( round_to_huge_pages( bytes ) );
+
+#ifdef __linux__
+  const int protection( PROT_READ | PROT_WRITE );
+  const int flags( MAP_PRIVATE | MAP_ANONYMOUS );
+  
+  void* result
+    ( mmap( nullptr, size, protection, flags | MAP_HUGETLB, -1, 0 ) );
+
+  if ( result == MAP_FAILED )
+    {
+      // The transparent huge pages must be aligned on their size, thus we
+      // map a larger range and keep its aligned part.
+      char* const range
+        ( static_cast< char* >
+          ( mmap( nullptr, size + huge_page_size, protection, flags, -1,
+                  0 ) ) );
+
+      if ( range == MAP_FAILED )
+        return nullptr;
+
+      const std::size_t head
+        ( round_to_huge_pages( std::uintptr_t( range ) )
+          - std::uintptr_t( range ) );
+      
+      if ( head != 0 )
+        munmap( range, head );
+
+      if ( head != huge_page_size )
+        munmap( range + head + size, huge_page_size - head );
+
+      result = range + head;
+      madvise( result, size, MADV_HUGEPAGE );
+    }
+
+  count_mapped_bytes( size );
+  return result;
+#else
+  return ::operator new( size, std::nothrow );
+#endif
+}
+
+void release_huge_pages( void* p, std::size_t bytes )
+{
+#ifdef __linux__
+  const std::size_t size( round_to_huge_pages( bytes ) );
+  
+  munmap( p, size );
+  uncount_mapped_bytes( size );
+#else
+  ::operator delete( p );
+#endif
+}
+
+bool parse_huge_page_mode( huge_page_mode& result, const char* name )
+{
+  if ( std::strcmp( name, "off" ) == 0 )
+    result = huge_page_mode::off;
+  else if ( std::strcmp( name, "on" ) == 0 )
+    result = huge_page_mode::on;
+  else if ( std::strcmp( name, "compare" ) == 0 )
+    result = huge_page_mode::compare;
+  else
+    return false;
+
+  return true;
+}
+
+const char* huge_page_mode_name( huge_page_mode mode )
+{
+  switch ( mode )
+    {
+    case huge_page_mode::off:
+      return "off";
+    case huge_page_mode::on:
+      return "on";
+    case huge_page_mode::compare:
+      return "compare";
+    }
+
+  return "unknown";
+}
@@ -0,0 +1,34 @@
+#include "key_source.hpp"
+
+key_source::~key_source() = default;
+
+vector_key_source::vector_key_source( const std::vector< std::string >& words )
+  : m_words( words ),
+    m_index( 0 )
+{
+
+}
+
+bool vector_key_source::next( std::string& key )
+{
+  if ( m_index == m_words.size() )
+    return false;
+
+  key = m_words[ m_index ];
+  ++m_index;
+
+  return true;
+}
+
+corpus::~corpus() = default;
+
+word_list_corpus::word_list_corpus( const std::vector< std::string >& words )
+  : m_words( words )
+{
+
+}
+
+std::unique_ptr< key_source > word_list_corpus::keys() const
+{
+  return std::unique_ptr< key_source >( new vector_key_source( m_words ) );
+}
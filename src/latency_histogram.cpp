@@ -0,0 +1,92 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+
+/**
+ * The number of significant bits kept for each value. The values below
+ * 2^precision_bits are recorded exactly; above, the buckets are 2^-6 times
+ * as wide as their lowest value.
+ */
+static constexpr unsigned precision_bits( 7 );
+static constexpr std::size_t half_bucket_count
+( std::size_t( 1 ) << ( precision_bits - 1 ) );
+
+latency_histogram::latency_histogram()
+  : m_counts( bucket_index( UINT64_MAX ) + 1, 0 ),
+    m_count( 0 ),
+    m_max( 0 )
+{
+
+}
+
+void latency_histogram::record( std::uint64_t value )
+{
+  ++m_counts[ bucket_index( value ) ];
+  ++m_count;
+  m_max = std::max( m_max, value );
+}
+
+void latency_histogram::merge( const latency_histogram& that )
+{
+  for ( std::size_t i( 0 ); i != m_counts.size(); ++i )
+    m_counts[ i ] += that.m_counts[ i ];
+
+  m_count += that.m_count;
+  m_max = std::max( m_max, that.m_max );
+}
+
+std::uint64_t latency_histogram::count() const
+{
+  return m_count;
+}
+
+std::uint64_t latency_histogram::max() const
+{
+  return m_max;
+}
+
+std::uint64_t latency_histogram::percentile( double q ) const
+{
+  if ( m_count == 0 )
+    return 0;
+
+  // The nearest rank, as in percentile() for the sorted samples.
+  const std::uint64_t rank
+    ( std::min< std::uint64_t >( q * m_count, m_count - 1 ) );
+  std::uint64_t seen( 0 );
+  
+  for ( std::size_t i( 0 ); i != m_counts.size(); ++i )
+    {
+      seen += m_counts[ i ];
+
+      if ( seen > rank )
+        return std::min( m_max, highest_equivalent_value( i ) );
+    }
+
+  return m_max;
+}
+
+std::size_t latency_histogram::bucket_index( std::uint64_t value )
+{
+  if ( value < 2 * half_bucket_count )
+    return value;
+
+  // The value is shifted such that its precision_bits highest bits remain,
+  // the highest one being set. Thus each magnitude has half_bucket_count
+  // buckets.
+  const unsigned magnitude
+    ( 63 - __builtin_clzll( value ) - ( precision_bits - 1 ) );
+
+  return magnitude * half_bucket_count + ( value >> magnitude );
+}
+
+std::uint64_t latency_histogram::highest_equivalent_value( std::size_t index )
+{
+  if ( index < 2 * half_bucket_count )
+    return index;
+
+  const unsigned magnitude( index / half_bucket_count - 1 );
+  const std::uint64_t significand( index - magnitude * half_bucket_count );
+
+  return ( ( significand + 1 ) << magnitude ) - 1;
+}
@@ -1,21 +1,394 @@
 #include "benchmark.hpp"
+#include "engine.hpp"
 #include "trie.hpp"
+#include "verification.hpp"
 
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
+
+/**
+ * Splits a comma separated list. The commas between parentheses are kept,
+ * as in the engine names like "hashset(code,hash)".
+ */
+static std::vector< std::string > split( const char* list )
+{
+  std::vector< std::string > result;
+  std::string s;
+  int depth( 0 );
+  
+  for ( const char* c( list ); *c != 0; ++c )
+    {
+      if ( ( *c == ',' ) && ( depth == 0 ) )
+        {
+          if ( !s.empty() )
+            result.push_back( s );
+
+          s.clear();
+          continue;
+        }
+
+      if ( *c == '(' )
+        ++depth;
+      else if ( ( *c == ')' ) && ( depth != 0 ) )
+        --depth;
+
+      s += *c;
+    }
+
+  if ( !s.empty() )
+    result.push_back( s );
+
+  return result;
+}
+
+/** Parses a range of the form "min-max", "min-" or "length". */
+static bool parse_range
+( std::size_t& min, std::size_t& max, const char* range )
+{
+  char* end;
+  min = std::strtoull( range, &end, 10 );
+
+  if ( end == range )
+    return false;
+  
+  if ( *end == 0 )
+    {
+      max = min;
+      return true;
+    }
+
+  if ( *end != '-' )
+    return false;
+
+  range = end + 1;
+
+  if ( *range == 0 )
+    {
+      max = std::numeric_limits< std::size_t >::max();
+      return true;
+    }
+  
+  max = std::strtoull( range, &end, 10 );
+  return ( end != range ) && ( *end == 0 ) && ( min <= max );
+}
+
+static void usage( const char* program )
+{
+  std::cerr << "Usage: " << program
+            << " [options] word_list_file\n"
+    "Options:\n"
+    "  --corpus file         The word list, instead of word_list_file.\n"
+    "  --engines name,...    The engines to measure, all of them by default.\n"
+    "  --baseline name       The engine to which the others are compared.\n"
+    "  --list-engines        Print the names of the engines then exit.\n"
+    "  --runs count          Lookups of each needle in the per length test.\n"
+    "  --lengths min-max     Lengths of the needles.\n"
+    "  --bucket-width count  Lengths per bucket in the per length test.\n"
+    "  --bucket-limit length Report longer needles in a single bucket.\n"
+    "  --throughput queries  Lookups per pass over shuffled needles.\n"
+    "  --ci percent          Target half width of the confidence interval of\n"
+    "                        the throughput, relative to the mean.\n"
+    "  --batches min-max     Bounds of the passes of the throughput test, the\n"
+    "                        lower one being at least 2.\n"
+    "  --noise-cv percent    Coefficient of variation above which a throughput\n"
+    "                        is flagged as noisy.\n"
+    "  --cpu id              Pin the measurements to this CPU.\n"
+    "  --huge-pages off|on|compare\n"
+    "                        Put the structures on huge pages, or measure\n"
+    "                        them with and without huge pages.\n"
+    "  --seed seed           Seed of the random generators.\n"
+    "  --threads count       Measure the scaling up to count threads.\n"
+    "  --cold lookups        Lookups done each after evicting the caches.\n"
+    "  --noisy-neighbors count\n"
+    "                        Measure the throughput again while count threads\n"
+    "                        thrash the last level cache.\n"
+    "  --open-loop requests  Lookups issued at each rate of the open loop test.\n"
+    "  --open-loop-qps rate  First rate of the open loop test, per second.\n"
+    "  --open-loop-factor factor\n"
+    "                        Growth of the rate at each step of the test.\n"
+    "  --open-loop-steps count\n"
+    "                        Highest number of rates in the open loop test.\n"
+    "  --open-loop-threads count\n"
+    "                        Threads issuing the lookups of the test.\n"
+    "  --batch size          Measure the throughput again with the needles\n"
+    "                        passed by batches of this size to the engines\n"
+    "                        supporting it.\n"
+    "  --load-factor ratio   Highest load factor of the open addressing hash\n"
+    "                        sets, in (0, 1).\n"
+    "  --encoders passes     Measure the batch word encoders in this number of\n"
+    "                        passes over the needles.\n"
+    "  --verify probes       Needles checked in the verification of the\n"
+    "                        engines, zero to skip it.\n"
+    "  --fuzz rounds         Verify the engines on fuzzed corpora then exit.\n"
+    "  --sample count        Keys of the corpus used as needles, zero for all.\n"
+    "  --synthetic keys      Measure a corpus of this size generated from a\n"
+    "                        Markov model of the word list.\n"
+    "  --synthetic-order order\n"
+    "                        Letters predicting the next one in the model.\n"
+    "  --synthetic-smoothing weight\n"
+    "                        Weight in [0, 1] of uniform letters in the model.\n"
+    "  --synthetic-alphabet letters\n"
+    "                        Letters of the generated keys.\n"
+    "  --synthetic-lengths min-max\n"
+    "                        Lengths of the generated keys.\n"
+    "  --workload queries    Number of needles of the skewed workload.\n"
+    "  --zipf exponent       Zipf exponent of the workload's hits.\n"
+    "  --hit-ratio ratio     Proportion of hits in the workload.\n"
+    "  --miss random|edit|prefix\n"
+    "                        How the workload's misses are built.\n"
+    "  --workload-lengths min-max\n"
+    "                        Lengths of the workload's needles.\n"
+    "  --workload-distribution corpus|uniform\n"
+    "                        Length distribution of the workload.\n"
+    "  --prefixes queries    Number of queries counting the words starting\n"
+    "                        with a prefix.\n"
+    "  --updates operations  Number of lookups, insertions and removals\n"
+    "                        applied to the engines which can be modified.\n"
+    "  --update-mix contains:insert:erase\n"
+    "                        Proportions of the operations of the updates.\n"
+    "  --replay file         Replay the queries of a log, one per line,\n"
+    "                        optionally preceded by a timestamp in seconds.\n"
+    "  --replay-timing asap|recorded\n"
+    "                        Issue the queries as fast as possible or at\n"
+    "                        their recorded times.\n"
+    "  --replay-speed factor Acceleration of the recorded timing.\n"
+    "  --format text|json|csv\n"
+    "                        Format of the output.\n";
+}
 
 int main( int argc, char* argv[])
 {
   test_trie();
+
+  benchmark_options options;
+  options.runs = 1000;
+  options.min_length = 0;
+  options.max_length = std::numeric_limits< std::size_t >::max();
+  options.bucket_width = 1;
+  options.bucket_limit = 0;
+  options.queries = 0;
+  options.target_ci = 0.01;
+  options.min_batches = 5;
+  options.max_batches = 100;
+  options.noise_cv = 0.05;
+  options.cpu = -1;
+  options.huge_pages = huge_page_mode::off;
+  options.seed = 0;
+  options.threads = 0;
+  options.cold_lookups = 0;
+  options.noisy_neighbors = 0;
+  options.open_loop_requests = 0;
+  options.open_loop_qps = 100000;
+  options.open_loop_factor = 2;
+  options.open_loop_steps = 10;
+  options.open_loop_threads = 1;
+  options.batch_size = 0;
+  options.max_load_factor = 0.875;
+  options.encoder_passes = 0;
+  options.probes = 100000;
+  options.sample = 0;
+  options.synthetic.keys = 0;
+  options.synthetic.order = 3;
+  options.synthetic.smoothing = 0.05;
+  options.synthetic.min_length = 1;
+  options.synthetic.max_length = std::numeric_limits< std::size_t >::max();
+  options.workload.queries = 0;
+  options.workload.zipf_exponent = 1;
+  options.workload.hit_ratio = 0.9;
+  options.workload.misses = miss_kind::random_letters;
+  options.workload.min_length = 0;
+  options.workload.max_length = std::numeric_limits< std::size_t >::max();
+  options.workload.lengths = length_distribution::corpus;
+  options.prefix_queries = 0;
+  options.updates.operations = 0;
+  options.updates.insert_ratio = 0.1;
+  options.updates.erase_ratio = 0.1;
+  options.replay_mode = replay_timing::as_fast_as_possible;
+  options.replay_speed = 1;
+  options.format = output_format::text;
   
-  if ( argc != 2 )
+  const char* word_list( nullptr );
+  std::size_t fuzz_rounds( 0 );
+  bool valid( true );
+  
+  for ( int i( 1 ); valid && ( i != argc ); ++i )
     {
-      std::cerr << "Usage: " << argv[ 0 ] << " word_list_file\n";
+      const char* const arg( argv[ i ] );
+      const char* const value( ( i + 1 < argc ) ? argv[ i + 1 ] : nullptr );
+
+      if ( ( arg[ 0 ] != '-' ) || ( arg[ 1 ] != '-' ) )
+        {
+          valid = ( word_list == nullptr );
+          word_list = arg;
+          continue;
+        }
+
+      if ( std::strcmp( arg, "--list-engines" ) == 0 )
+        {
+          for ( const std::string& name : engine_registry::names() )
+            std::cout << name << '\n';
+
+          return 0;
+        }
+      
+      ++i;
+      
+      if ( value == nullptr )
+        valid = false;
+      else if ( std::strcmp( arg, "--corpus" ) == 0 )
+        {
+          valid = ( word_list == nullptr );
+          word_list = value;
+        }
+      else if ( std::strcmp( arg, "--engines" ) == 0 )
+        options.engines = split( value );
+      else if ( std::strcmp( arg, "--baseline" ) == 0 )
+        options.baseline = value;
+      else if ( std::strcmp( arg, "--runs" ) == 0 )
+        options.runs = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--lengths" ) == 0 )
+        valid = parse_range( options.min_length, options.max_length, value );
+      else if ( std::strcmp( arg, "--bucket-width" ) == 0 )
+        {
+          options.bucket_width = std::strtoull( value, nullptr, 10 );
+          valid = ( options.bucket_width != 0 );
+        }
+      else if ( std::strcmp( arg, "--bucket-limit" ) == 0 )
+        options.bucket_limit = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--throughput" ) == 0 )
+        options.queries = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--ci" ) == 0 )
+        options.target_ci = std::strtod( value, nullptr ) / 100;
+      else if ( std::strcmp( arg, "--batches" ) == 0 )
+        valid =
+          parse_range( options.min_batches, options.max_batches, value )
+          && ( options.min_batches >= 2 )
+          && ( options.max_batches
+               != std::numeric_limits< std::size_t >::max() );
+      else if ( std::strcmp( arg, "--noise-cv" ) == 0 )
+        options.noise_cv = std::strtod( value, nullptr ) / 100;
+      else if ( std::strcmp( arg, "--cpu" ) == 0 )
+        options.cpu = std::atoi( value );
+      else if ( std::strcmp( arg, "--huge-pages" ) == 0 )
+        valid = parse_huge_page_mode( options.huge_pages, value );
+      else if ( std::strcmp( arg, "--seed" ) == 0 )
+        options.seed = std::strtoul( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--threads" ) == 0 )
+        options.threads = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--cold" ) == 0 )
+        options.cold_lookups = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--noisy-neighbors" ) == 0 )
+        options.noisy_neighbors = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--open-loop" ) == 0 )
+        options.open_loop_requests = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--open-loop-qps" ) == 0 )
+        {
+          options.open_loop_qps = std::strtod( value, nullptr );
+          valid = ( options.open_loop_qps > 0 );
+        }
+      else if ( std::strcmp( arg, "--open-loop-factor" ) == 0 )
+        {
+          options.open_loop_factor = std::strtod( value, nullptr );
+          valid = ( options.open_loop_factor > 1 );
+        }
+      else if ( std::strcmp( arg, "--open-loop-steps" ) == 0 )
+        options.open_loop_steps = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--open-loop-threads" ) == 0 )
+        {
+          options.open_loop_threads = std::strtoull( value, nullptr, 10 );
+          valid = ( options.open_loop_threads != 0 );
+        }
+      else if ( std::strcmp( arg, "--batch" ) == 0 )
+        options.batch_size = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--load-factor" ) == 0 )
+        {
+          options.max_load_factor = std::strtod( value, nullptr );
+          valid =
+            ( options.max_load_factor > 0 ) && ( options.max_load_factor < 1 );
+        }
+      else if ( std::strcmp( arg, "--encoders" ) == 0 )
+        options.encoder_passes = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--verify" ) == 0 )
+        options.probes = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--fuzz" ) == 0 )
+        fuzz_rounds = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--sample" ) == 0 )
+        options.sample = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--synthetic" ) == 0 )
+        options.synthetic.keys = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--synthetic-order" ) == 0 )
+        options.synthetic.order = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--synthetic-smoothing" ) == 0 )
+        options.synthetic.smoothing = std::strtod( value, nullptr );
+      else if ( std::strcmp( arg, "--synthetic-alphabet" ) == 0 )
+        options.synthetic.alphabet = value;
+      else if ( std::strcmp( arg, "--synthetic-lengths" ) == 0 )
+        valid =
+          parse_range
+          ( options.synthetic.min_length, options.synthetic.max_length,
+            value );
+      else if ( std::strcmp( arg, "--workload" ) == 0 )
+        options.workload.queries = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--zipf" ) == 0 )
+        options.workload.zipf_exponent = std::strtod( value, nullptr );
+      else if ( std::strcmp( arg, "--hit-ratio" ) == 0 )
+        options.workload.hit_ratio = std::strtod( value, nullptr );
+      else if ( std::strcmp( arg, "--miss" ) == 0 )
+        valid = parse_miss_kind( options.workload.misses, value );
+      else if ( std::strcmp( arg, "--workload-lengths" ) == 0 )
+        valid =
+          parse_range
+          ( options.workload.min_length, options.workload.max_length, value );
+      else if ( std::strcmp( arg, "--workload-distribution" ) == 0 )
+        valid = parse_length_distribution( options.workload.lengths, value );
+      else if ( std::strcmp( arg, "--prefixes" ) == 0 )
+        options.prefix_queries = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--updates" ) == 0 )
+        options.updates.operations = std::strtoull( value, nullptr, 10 );
+      else if ( std::strcmp( arg, "--update-mix" ) == 0 )
+        valid = parse_update_mix( options.updates, value );
+      else if ( std::strcmp( arg, "--replay" ) == 0 )
+        options.replay = value;
+      else if ( std::strcmp( arg, "--replay-timing" ) == 0 )
+        valid = parse_replay_timing( options.replay_mode, value );
+      else if ( std::strcmp( arg, "--replay-speed" ) == 0 )
+        {
+          options.replay_speed = std::strtod( value, nullptr );
+          valid = ( options.replay_speed > 0 );
+        }
+      else if ( std::strcmp( arg, "--format" ) == 0 )
+        valid = parse_output_format( options.format, value );
+      else
+        valid = false;
+    }
+  
+  if ( valid && ( fuzz_rounds != 0 ) )
+    {
+      if ( !fuzz_engines( options.engines, fuzz_rounds, options.seed ) )
+        return 1;
+
+      std::cout << fuzz_rounds << " fuzzed corpora verified.\n";
+      return 0;
+    }
+  
+  if ( !valid || ( word_list == nullptr ) || ( options.runs == 0 )
+       || ( options.workload.hit_ratio < 0 )
+       || ( options.workload.hit_ratio > 1 ) )
+    {
+      usage( argv[ 0 ] );
       return 1;
     }
   
-  std::ifstream f( argv[ 1 ] );
-  bench_all( std::cout, f );
+  std::ifstream f( word_list );
+
+  if ( !f )
+    {
+      std::cerr << "Could not open " << word_list << ".\n";
+      return 1;
+    }
   
-  return 0;
+  return bench_all( std::cout, f, options ) ? 0 : 1;
 }
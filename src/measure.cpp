@@ -0,0 +1,107 @@
+#include "measure.hpp"
+
+#include <limits>
+
+std::size_t g_runs( 1000 );
+std::size_t g_min_batches( 5 );
+std::size_t g_max_batches( 100 );
+double g_target_ci( 0.01 );
+double g_noise_cv( 0.05 );
+std::size_t g_scaling_threads( 0 );
+std::size_t g_cold_lookups( 0 );
+std::size_t g_noisy_neighbors( 0 );
+std::size_t g_open_loop_requests( 0 );
+double g_open_loop_qps( 100000 );
+double g_open_loop_factor( 2 );
+std::size_t g_open_loop_steps( 10 );
+std::size_t g_open_loop_threads( 1 );
+std::size_t g_batch_size( 0 );
+std::size_t g_bucket_width( 1 );
+std::size_t g_bucket_limit( 0 );
+
+std::chrono::nanoseconds now()
+{
+  return
+    std::chrono::duration_cast< std::chrono::nanoseconds >
+    ( std::chrono::steady_clock::now().time_since_epoch() );
+}
+
+perf_counters& hardware_counters()
+{
+  static perf_counters result;
+  return result;
+}
+
+perf_counters::sample per_lookup
+( perf_counters::sample sample, std::size_t lookups )
+{
+  for ( double& v : sample )
+    if ( v >= 0 )
+      v /= std::max< std::size_t >( 1, lookups );
+
+  return sample;
+}
+
+latency_summary summarize_latency( std::vector< double >& durations )
+{
+  if ( durations.empty() )
+    return latency_summary{ 0, 0, 0, 0, 0, 0 };
+
+  std::sort( durations.begin(), durations.end() );
+
+  return latency_summary
+    {
+      durations.size(),
+      percentile( durations, 0.5 ),
+      percentile( durations, 0.9 ),
+      percentile( durations, 0.99 ),
+      percentile( durations, 0.999 ),
+      durations.back()
+    };
+}
+
+latency_summary summarize_latency( const latency_histogram& durations )
+{
+  if ( durations.count() == 0 )
+    return latency_summary{ 0, 0, 0, 0, 0, 0 };
+
+  return latency_summary
+    {
+      durations.count(),
+      double( durations.percentile( 0.5 ) ),
+      double( durations.percentile( 0.9 ) ),
+      double( durations.percentile( 0.99 ) ),
+      double( durations.percentile( 0.999 ) ),
+      double( durations.max() )
+    };
+}
+
+std::size_t length_bucket_index( std::size_t length )
+{
+  if ( ( g_bucket_limit == 0 ) || ( length < g_bucket_limit ) )
+    return length / g_bucket_width;
+
+  return ( g_bucket_limit + g_bucket_width - 1 ) / g_bucket_width;
+}
+
+length_bucket make_length_bucket( std::size_t index )
+{
+  length_bucket result;
+  result.min_length = index * g_bucket_width;
+  result.max_length = result.min_length + g_bucket_width - 1;
+
+  if ( g_bucket_limit != 0 )
+    {
+      if ( result.min_length >= g_bucket_limit )
+        {
+          result.min_length = g_bucket_limit;
+          result.max_length = std::numeric_limits< std::size_t >::max();
+        }
+      else
+        result.max_length =
+          std::min( result.max_length, g_bucket_limit - 1 );
+    }
+
+  result.latency = latency_summary{ 0, 0, 0, 0, 0, 0 };
+  return result;
+}
@@ -0,0 +1,201 @@
+#include "memory_usage.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined( __GLIBC__ )
+  #include <malloc.h>
+  #include <unistd.h>
+  #define HAS_USABLE_SIZE 1
+#elif defined( __APPLE__ )
+  #include <malloc/malloc.h>
+  #define HAS_USABLE_SIZE 1
+#else
+  #define HAS_USABLE_SIZE 0
+#endif
+
+static std::atomic< std::size_t > g_allocated_bytes( 0 );
+static std::atomic< std::size_t > g_peak_allocated_bytes( 0 );
+
+static std::size_t usable_size( void* p )
+{
+#if defined( __GLIBC__ )
+  return malloc_usable_size( p );
+#elif defined( __APPLE__ )
+  return malloc_size( p );
+#else
+  return 0;
+#endif
+}
+
+static void count_allocation( std::size_t size ) noexcept
+{
+  const std::size_t allocated
+    ( g_allocated_bytes.fetch_add( size, std::memory_order_relaxed ) + size );
+  std::size_t peak( g_peak_allocated_bytes.load( std::memory_order_relaxed ) );
+
+  while ( ( peak < allocated )
+          && !g_peak_allocated_bytes.compare_exchange_weak
+          ( peak, allocated, std::memory_order_relaxed ) )
+    ;
+}
+
+static void* counted_allocate( std::size_t size ) noexcept
+{
+  void* const result( std::malloc( ( size == 0 ) ? 1 : size ) );
+
+  if ( result == nullptr )
+    return nullptr;
+
+  count_allocation( usable_size( result ) );
+  return result;
+}
+
+static void counted_release( void* p ) noexcept
+{
+  if ( p == nullptr )
+    return;
+  
+  g_allocated_bytes.fetch_sub( usable_size( p ), std::memory_order_relaxed );
+  std::free( p );
+}
+
+void* operator new( std::size_t size )
+{
+  void* const result( counted_allocate( size ) );
+
+  if ( result == nullptr )
+    throw std::bad_alloc();
+
+  return result;
+}
+
+void* operator new[]( std::size_t size )
+{
+  return operator new( size );
+}
+
+void* operator new( std::size_t size, const std::nothrow_t& ) noexcept
+{
+  return counted_allocate( size );
+}
+
+void* operator new[]( std::size_t size, const std::nothrow_t& ) noexcept
+{
+  return counted_allocate( size );
+}
+
+void operator delete( void* p ) noexcept
+{
+  counted_release( p );
+}
+
+void operator delete[]( void* p ) noexcept
+{
+  counted_release( p );
+}
+
+void operator delete( void* p, const std::nothrow_t& ) noexcept
+{
+  counted_release( p );
+}
+
+void operator delete[]( void* p, const std::nothrow_t& ) noexcept
+{
+  counted_release( p );
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete( void* p, std::size_t ) noexcept
+{
+  counted_release( p );
+}
+
+void operator delete[]( void* p, std::size_t ) noexcept
+{
+  counted_release( p );
+}
+#endif
+
+void count_mapped_bytes( std::size_t bytes )
+{
+  count_allocation( bytes );
+}
+
+void uncount_mapped_bytes( std::size_t bytes )
+{
+  g_allocated_bytes.fetch_sub( bytes, std::memory_order_relaxed );
+}
+
+bool allocation_tracking_available()
+{
+  return HAS_USABLE_SIZE;
+}
+
+std::size_t allocated_bytes()
+{
+  return g_allocated_bytes.load( std::memory_order_relaxed );
+}
+
+std::size_t peak_allocated_bytes()
+{
+  return g_peak_allocated_bytes.load( std::memory_order_relaxed );
+}
+
+void reset_peak_allocated_bytes()
+{
+  g_peak_allocated_bytes.store
+    ( g_allocated_bytes.load( std::memory_order_relaxed ),
+      std::memory_order_relaxed );
+}
+
+std::size_t resident_set_size()
+{
+#ifdef __linux__
+  std::FILE* const f( std::fopen( "/proc/self/statm", "r" ) );
+
+  if ( f == nullptr )
+    return 0;
+
+  unsigned long size;
+  unsigned long resident;
+  const int fields( std::fscanf( f, "%lu %lu", &size, &resident ) );
+  std::fclose( f );
+
+  if ( fields != 2 )
+    return 0;
+  
+  return resident * sysconf( _SC_PAGESIZE );
+#else
+  return 0;
+#endif
+}
+
+footprint_meter::footprint_meter()
+{
+#if defined( __GLIBC__ )
+  malloc_trim( 0 );
+#endif
+  
+  m_initial.allocated = allocated_bytes();
+  m_initial.resident = resident_set_size();
+  m_initial.peak = m_initial.allocated;
+  
+  reset_peak_allocated_bytes();
+}
+
+footprint footprint_meter::get() const
+{
+  const std::size_t allocated( allocated_bytes() );
+  const std::size_t resident( resident_set_size() );
+  const std::size_t peak( peak_allocated_bytes() );
+  
+  return footprint
+    {
+      ( allocated > m_initial.allocated ) ? allocated - m_initial.allocated : 0,
+      ( resident > m_initial.resident ) ? resident - m_initial.resident : 0,
+      ( peak > m_initial.peak ) ? peak - m_initial.peak : 0
+    };
+}
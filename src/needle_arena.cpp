@@ -0,0 +1,36 @@
+#include "needle_arena.hpp"
+
+needle_arena::needle_arena( const std::vector< std::string >& words )
+{
+  std::size_t size( 0 );
+
+  for ( const std::string& w : words )
+    size += w.size();
+
+  m_letters.reserve( size );
+  m_offsets.reserve( words.size() + 1 );
+
+  for ( const std::string& w : words )
+    {
+      m_offsets.push_back( m_letters.size() );
+      m_letters.insert( m_letters.end(), w.begin(), w.end() );
+    }
+
+  m_offsets.push_back( m_letters.size() );
+}
+
+bool needle_arena::empty() const
+{
+  return size() == 0;
+}
+
+std::size_t needle_arena::size() const
+{
+  return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+}
+
+word_view needle_arena::operator[]( std::size_t i ) const
+{
+  return word_view
+    ( m_letters.data() + m_offsets[ i ], m_offsets[ i + 1 ] - m_offsets[ i ] );
+}
@@ -0,0 +1,142 @@
+#include "perf_counters.hpp"
+
+#ifdef __linux__
+  #include <cstdint>
+  #include <cstring>
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+#ifdef __linux__
+static int open_counter( std::uint32_t type, std::uint64_t config )
+{
+  perf_event_attr attr;
+  std::memset( &attr, 0, sizeof( attr ) );
+
+  attr.size = sizeof( attr );
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+    PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 );
+}
+
+static std::uint64_t cache_config
+( std::uint64_t cache, std::uint64_t operation, std::uint64_t result )
+{
+  return cache | ( operation << 8 ) | ( result << 16 );
+}
+#endif
+
+perf_counters::perf_counters()
+{
+  m_fd.fill( -1 );
+
+#ifdef __linux__
+  m_fd[ cycles ] =
+    open_counter( PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES );
+  m_fd[ instructions ] =
+    open_counter( PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS );
+  m_fd[ l1d_misses ] =
+    open_counter
+    ( PERF_TYPE_HW_CACHE,
+      cache_config
+      ( PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+        PERF_COUNT_HW_CACHE_RESULT_MISS ) );
+  m_fd[ llc_misses ] =
+    open_counter
+    ( PERF_TYPE_HW_CACHE,
+      cache_config
+      ( PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ,
+        PERF_COUNT_HW_CACHE_RESULT_MISS ) );
+  m_fd[ dtlb_misses ] =
+    open_counter
+    ( PERF_TYPE_HW_CACHE,
+      cache_config
+      ( PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+        PERF_COUNT_HW_CACHE_RESULT_MISS ) );
+  m_fd[ branch_misses ] =
+    open_counter( PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES );
+#endif
+}
+
+perf_counters::~perf_counters()
+{
+#ifdef __linux__
+  for ( int fd : m_fd )
+    if ( fd != -1 )
+      close( fd );
+#endif
+}
+
+bool perf_counters::available() const
+{
+  for ( int fd : m_fd )
+    if ( fd != -1 )
+      return true;
+
+  return false;
+}
+
+void perf_counters::start()
+{
+#ifdef __linux__
+  for ( int fd : m_fd )
+    if ( fd != -1 )
+      {
+        ioctl( fd, PERF_EVENT_IOC_RESET, 0 );
+        ioctl( fd, PERF_EVENT_IOC_ENABLE, 0 );
+      }
+#endif
+}
+
+perf_counters::sample perf_counters::stop()
+{
+  sample result;
+  result.fill( -1 );
+  
+#ifdef __linux__
+  for ( int fd : m_fd )
+    if ( fd != -1 )
+      ioctl( fd, PERF_EVENT_IOC_DISABLE, 0 );
+
+  for ( std::size_t i( 0 ); i != counter_count; ++i )
+    {
+      if ( m_fd[ i ] == -1 )
+        continue;
+
+      // value, time enabled, time running.
+      std::uint64_t values[ 3 ];
+
+      if ( ( read( m_fd[ i ], values, sizeof( values ) )
+             != sizeof( values ) )
+           || ( values[ 2 ] == 0 ) )
+        continue;
+
+      // Scale the count if the counter has been multiplexed with others.
+      result[ i ] = (double)values[ 0 ] * values[ 1 ] / values[ 2 ];
+    }
+#endif
+
+  return result;
+}
+
+const char* perf_counters::name( counter c )
+{
+  switch ( c )
+    {
+    case cycles: return "cycles";
+    case instructions: return "instructions";
+    case l1d_misses: return "L1D-misses";
+    case llc_misses: return "LLC-misses";
+    case dtlb_misses: return "dTLB-misses";
+    case branch_misses: return "branch-misses";
+    default: return "";
+    }
+}
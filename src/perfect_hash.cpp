@@ -0,0 +1,588 @@
+#include "perfect_hash.hpp"
+
+#include "mix_hash.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+#ifdef __linux__
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+/** Tells the files written by perfect_hash::save(). */
+static constexpr std::uint64_t g_perfect_hash_magic( 0x32687361686870ull );
+
+/** The average number of keys in the buckets sharing a pilot. */
+static constexpr std::size_t pilot_bucket_size( 6 );
+
+/**
+ * The keys are not spread evenly in the buckets: 60% of them go to the 30%
+ * first buckets. The large buckets are placed first, when most slots are
+ * free, and the many small buckets left fit in the last free slots. With
+ * even buckets, those of four keys would have to be placed when 90% of the
+ * slots are taken.
+ */
+static constexpr std::uint64_t dense_key_tenths( 6 );
+static constexpr std::uint64_t dense_bucket_tenths( 3 );
+
+/** The average number of keys in a partition. */
+static constexpr std::size_t partition_size( 4096 );
+
+/**
+ * The slots of the table of a partition are 1% more than its keys, such
+ * that the last buckets still find free slots in a few hundred trials.
+ */
+static constexpr std::size_t slack_ratio( 99 );
+
+struct perfect_hash::header
+{
+  std::uint64_t magic;
+  std::uint64_t seed;
+  std::uint64_t keys;
+  std::uint64_t partitions;
+  std::uint64_t buckets;
+  std::uint64_t remapped;
+};
+
+struct perfect_hash::partition
+{
+  /** The index of the first key of the partition in the codes. */
+  std::uint32_t first_key;
+  std::uint32_t keys;
+  std::uint32_t first_bucket;
+  std::uint32_t buckets;
+
+  /** The number of buckets receiving the keys in dense_key_tenths. */
+  std::uint32_t dense_buckets;
+  std::uint32_t first_remap;
+  std::uint32_t table_size;
+
+  /**
+   * Mixed with the hashes of the keys of the partition, and changed until
+   * every bucket finds a pilot.
+   */
+  std::uint32_t seed;
+};
+
+namespace
+{
+  /**
+   * Maps the 64-bit value to [0, n) via the highest half of their product,
+   * and returns the lowest half, which can be mapped again.
+   */
+  std::uint64_t scale
+  ( std::uint64_t value, std::uint64_t n, std::uint64_t& low )
+  {
+    const unsigned __int128 product( (unsigned __int128)value * n );
+    low = product;
+    return product >> 64;
+  }
+
+  /** The hash of a key in its partition, given by the seed of the latter. */
+  std::uint64_t partition_hash( std::uint64_t hash, std::uint32_t seed )
+  {
+    return mix_hash( hash ^ seed );
+  }
+
+  /** The bucket of a key in its partition, from its partition_hash(). */
+  std::uint64_t bucket_of
+  ( std::uint64_t low, std::uint32_t buckets, std::uint32_t dense_buckets )
+  {
+    if ( scale( low, 10, low ) < dense_key_tenths )
+      return scale( low, dense_buckets, low );
+
+    return dense_buckets + scale( low, buckets - dense_buckets, low );
+  }
+
+  std::uint64_t slot_of
+  ( std::uint64_t hash, std::uint16_t pilot, std::uint32_t table_size )
+  {
+    return ( hash ^ mix_hash( pilot ) ) % table_size;
+  }
+
+  /** The number of 64-bit words needed for count values of type T. */
+  template< typename T >
+  std::size_t word_count( std::size_t count )
+  {
+    return ( count * sizeof( T ) + sizeof( std::uint64_t ) - 1 )
+      / sizeof( std::uint64_t );
+  }
+
+  /**
+   * Searches the pilots of a partition whose keys have the given hashes and
+   * codes, with the seed of the partition, then writes the pilots, the
+   * remapped slots and the codes in the order of their slot. Returns false
+   * if a bucket finds no pilot.
+   */
+  template< typename Partition >
+  bool build_partition
+  ( const Partition& p, const std::uint64_t* global_hashes,
+    const std::uint64_t* codes, std::uint16_t* pilots, std::uint32_t* remap,
+    std::uint64_t* sorted_codes )
+  {
+    std::vector< std::uint64_t > hashes( p.keys );
+
+    for ( std::uint32_t i( 0 ); i != p.keys; ++i )
+      hashes[ i ] = partition_hash( global_hashes[ i ], p.seed );
+
+    // The keys sorted by bucket.
+    std::vector< std::pair< std::uint64_t, std::uint32_t > > keys( p.keys );
+
+    for ( std::uint32_t i( 0 ); i != p.keys; ++i )
+      keys[ i ] =
+        std::make_pair
+        ( bucket_of( hashes[ i ], p.buckets, p.dense_buckets ), i );
+
+    std::sort( keys.begin(), keys.end() );
+
+    // The range of each bucket in keys, the largest first.
+    std::vector< std::pair< std::uint32_t, std::uint32_t > > buckets;
+
+    for ( std::uint32_t i( 0 ); i != p.keys; )
+      {
+        std::uint32_t end( i + 1 );
+
+        while ( ( end != p.keys )
+                && ( keys[ end ].first == keys[ i ].first ) )
+          ++end;
+
+        buckets.emplace_back( i, end );
+        i = end;
+      }
+
+    std::stable_sort
+      ( buckets.begin(), buckets.end(),
+        []( const std::pair< std::uint32_t, std::uint32_t >& a,
+            const std::pair< std::uint32_t, std::uint32_t >& b ) -> bool
+        {
+          return a.second - a.first > b.second - b.first;
+        } );
+
+    std::fill( pilots, pilots + p.buckets, 0 );
+
+    // The key in each slot, plus one, or zero if the slot is free.
+    std::vector< std::uint32_t > slots( p.table_size, 0 );
+
+    for ( const std::pair< std::uint32_t, std::uint32_t >& b : buckets )
+      {
+        std::uint32_t pilot( 0 );
+
+        for ( ; pilot <= UINT16_MAX; ++pilot )
+          {
+            const auto slot
+              ( [ & ]( std::uint32_t i ) -> std::uint64_t
+                {
+                  return slot_of
+                    ( hashes[ keys[ i ].second ], pilot, p.table_size );
+                } );
+
+            std::uint32_t i( b.first );
+
+            for ( ; i != b.second; ++i )
+              {
+                std::uint32_t& s( slots[ slot( i ) ] );
+
+                if ( s != 0 )
+                  break;
+
+                s = keys[ i ].second + 1;
+              }
+
+            if ( i == b.second )
+              break;
+
+            for ( std::uint32_t j( b.first ); j != i; ++j )
+              slots[ slot( j ) ] = 0;
+          }
+
+        if ( pilot > UINT16_MAX )
+          return false;
+
+        pilots[ keys[ b.first ].first ] = pilot;
+      }
+
+    std::uint32_t free_slot( 0 );
+
+    for ( std::uint32_t slot( 0 ); slot != p.table_size; ++slot )
+      {
+        if ( slots[ slot ] == 0 )
+          {
+            if ( slot >= p.keys )
+              remap[ slot - p.keys ] = 0;
+
+            continue;
+          }
+
+        std::uint32_t target( slot );
+
+        if ( slot >= p.keys )
+          {
+            while ( slots[ free_slot ] != 0 )
+              ++free_slot;
+
+            target = free_slot;
+            ++free_slot;
+            remap[ slot - p.keys ] = target;
+          }
+
+        sorted_codes[ target ] = codes[ slots[ slot ] - 1 ];
+      }
+
+    return true;
+  }
+}
+
+perfect_hash::perfect_hash()
+  : m_mapping( nullptr ),
+    m_mapping_size( 0 )
+{
+  build( std::vector< std::uint64_t >(), 1 );
+}
+
+perfect_hash::~perfect_hash()
+{
+  clear();
+}
+
+void perfect_hash::build
+( std::vector< std::uint64_t > codes, std::size_t threads )
+{
+  std::sort( codes.begin(), codes.end() );
+  codes.erase( std::unique( codes.begin(), codes.end() ), codes.end() );
+
+  std::uint64_t attempt( 0 );
+
+  while ( !build_with_seed( codes, mix_hash( attempt + 1 ), threads ) )
+    ++attempt;
+}
+
+bool perfect_hash::contains( std::uint64_t code ) const
+{
+  const std::uint64_t partitions( m_header->partitions );
+
+  if ( partitions == 0 )
+    return false;
+
+  std::uint64_t hash( mix_hash( code ^ m_header->seed ) );
+  std::uint64_t low;
+  const partition& p( m_partitions[ scale( hash, partitions, low ) ] );
+
+  hash = partition_hash( hash, p.seed );
+  const std::uint64_t bucket( bucket_of( hash, p.buckets, p.dense_buckets ) );
+
+  std::uint64_t slot
+    ( slot_of( hash, m_pilots[ p.first_bucket + bucket ], p.table_size ) );
+
+  if ( slot >= p.keys )
+    slot = m_remap[ p.first_remap + slot - p.keys ];
+
+  return m_codes[ p.first_key + slot ] == code;
+}
+
+std::size_t perfect_hash::size() const
+{
+  return m_header->keys;
+}
+
+std::size_t perfect_hash::memory_usage() const
+{
+  if ( m_mapping != nullptr )
+    return m_mapping_size;
+
+  return m_image.size() * sizeof( std::uint64_t );
+}
+
+double perfect_hash::metadata_bits_per_key() const
+{
+  if ( m_header->keys == 0 )
+    return 0;
+
+  return double
+    ( m_header->buckets * 16 + m_header->remapped * 32
+      + m_header->partitions * sizeof( partition ) * 8 )
+    / m_header->keys;
+}
+
+bool perfect_hash::save( const std::string& path ) const
+{
+  const char* const data( reinterpret_cast< const char* >( m_header ) );
+
+  return bool
+    ( std::ofstream( path, std::ios::binary )
+      .write( data, memory_usage() ) );
+}
+
+bool perfect_hash::read( const std::string& path )
+{
+  clear();
+
+  std::ifstream f( path, std::ios::binary | std::ios::ate );
+
+  if ( !f )
+    return false;
+
+  const std::size_t bytes( f.tellg() );
+
+  if ( bytes % sizeof( std::uint64_t ) != 0 )
+    return false;
+
+  m_image.resize( bytes / sizeof( std::uint64_t ) );
+  f.seekg( 0 );
+
+  if ( f.read( reinterpret_cast< char* >( m_image.data() ), bytes )
+       && attach( m_image.data(), m_image.size() ) )
+    return true;
+
+  build( std::vector< std::uint64_t >(), 1 );
+  return false;
+}
+
+bool perfect_hash::map( const std::string& path )
+{
+  clear();
+
+#ifdef __linux__
+  const int fd( open( path.c_str(), O_RDONLY ) );
+  struct stat s;
+  void* mapping( MAP_FAILED );
+
+  if ( fd != -1 )
+    {
+      if ( ( fstat( fd, &s ) == 0 ) && ( s.st_size != 0 ) )
+        mapping = mmap( nullptr, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+      close( fd );
+    }
+
+  if ( mapping == MAP_FAILED )
+    {
+      build( std::vector< std::uint64_t >(), 1 );
+      return false;
+    }
+
+  m_mapping = mapping;
+  m_mapping_size = s.st_size;
+
+  if ( ( m_mapping_size % sizeof( std::uint64_t ) == 0 )
+       && attach
+       ( static_cast< const std::uint64_t* >( m_mapping ),
+         m_mapping_size / sizeof( std::uint64_t ) ) )
+    return true;
+
+  build( std::vector< std::uint64_t >(), 1 );
+#endif
+
+  return false;
+}
+
+void perfect_hash::clear()
+{
+#ifdef __linux__
+  if ( m_mapping != nullptr )
+    munmap( m_mapping, m_mapping_size );
+#endif
+
+  m_mapping = nullptr;
+  m_mapping_size = 0;
+  m_image.clear();
+  m_image.shrink_to_fit();
+  m_header = nullptr;
+  m_partitions = nullptr;
+  m_pilots = nullptr;
+  m_remap = nullptr;
+  m_codes = nullptr;
+}
+
+/**
+ * Points the parts of the structure in the given words, after checking
+ * that they are as large as the header tells. Returns false if they are
+ * not.
+ */
+bool perfect_hash::attach( const std::uint64_t* words, std::size_t size )
+{
+  const std::size_t header_words( word_count< header >( 1 ) );
+
+  if ( size < header_words )
+    return false;
+
+  const header* const h( reinterpret_cast< const header* >( words ) );
+
+  if ( h->magic != g_perfect_hash_magic )
+    return false;
+
+  const std::size_t partitions_words
+    ( word_count< partition >( h->partitions ) );
+  const std::size_t pilots_words( word_count< std::uint16_t >( h->buckets ) );
+  const std::size_t remap_words( word_count< std::uint32_t >( h->remapped ) );
+
+  if ( size
+       != header_words + partitions_words + pilots_words + remap_words
+       + h->keys )
+    return false;
+
+  const std::uint64_t* w( words + header_words );
+  m_header = h;
+  m_partitions = reinterpret_cast< const partition* >( w );
+  w += partitions_words;
+  m_pilots = reinterpret_cast< const std::uint16_t* >( w );
+  w += pilots_words;
+  m_remap = reinterpret_cast< const std::uint32_t* >( w );
+  w += remap_words;
+  m_codes = w;
+
+  return true;
+}
+
+/**
+ * Builds the structure for the given distinct codes, whose hash is
+ * computed with the given seed. Returns false if a partition is empty, in
+ * which case another seed must be tried. The partitions in which a bucket
+ * finds no pilot are built again with another seed of their own.
+ */
+bool perfect_hash::build_with_seed
+( const std::vector< std::uint64_t >& codes, std::uint64_t seed,
+  std::size_t threads )
+{
+  clear();
+
+  const std::size_t key_count( codes.size() );
+  const std::size_t partition_count
+    ( ( key_count == 0 ) ? 0 : std::max< std::size_t >
+      ( 1, key_count / partition_size ) );
+  threads = std::max< std::size_t >( 1, std::min( threads, partition_count ) );
+
+  // The hashes of the codes.
+  std::vector< std::uint64_t > hashes( key_count );
+  {
+    std::vector< std::thread > workers;
+
+    for ( std::size_t t( 0 ); t != threads; ++t )
+      workers.emplace_back
+        ( [ &, t ]() -> void
+          {
+            const std::size_t end( key_count * ( t + 1 ) / threads );
+
+            for ( std::size_t i( key_count * t / threads ); i != end; ++i )
+              hashes[ i ] = mix_hash( codes[ i ] ^ seed );
+          } );
+
+    for ( std::thread& t : workers )
+      t.join();
+  }
+
+  // The hashes and the codes grouped by partition.
+  std::vector< partition > partitions( partition_count );
+  std::vector< std::uint32_t > partition_of( key_count );
+
+  for ( std::size_t i( 0 ); i != key_count; ++i )
+    {
+      std::uint64_t low;
+      partition_of[ i ] = scale( hashes[ i ], partition_count, low );
+      ++partitions[ partition_of[ i ] ].keys;
+    }
+
+  std::uint32_t first_key( 0 );
+  std::uint32_t first_bucket( 0 );
+  std::uint32_t first_remap( 0 );
+
+  for ( partition& p : partitions )
+    {
+      if ( p.keys == 0 )
+        return false;
+
+      p.first_key = first_key;
+      p.first_bucket = first_bucket;
+      p.buckets = ( p.keys + pilot_bucket_size - 1 ) / pilot_bucket_size;
+      p.dense_buckets = p.buckets * dense_bucket_tenths / 10;
+      p.first_remap = first_remap;
+
+      // The slot of a key is its hash modulo the table size, thus a size
+      // multiple of 2^k keeps the k lowest bits of the hash. With a power
+      // of two, the keys of a bucket whose lowest bits are the same always
+      // collide, whatever the pilot or the seed.
+      p.table_size =
+        ( p.keys + ( p.keys + slack_ratio - 1 ) / slack_ratio ) | 1;
+      p.seed = 0;
+
+      first_key += p.keys;
+      first_bucket += p.buckets;
+      first_remap += p.table_size - p.keys;
+    }
+
+  std::vector< std::uint64_t > partition_hashes( key_count );
+  std::vector< std::uint64_t > partition_codes( key_count );
+  {
+    std::vector< std::uint32_t > next( partition_count );
+
+    for ( std::size_t i( 0 ); i != partition_count; ++i )
+      next[ i ] = partitions[ i ].first_key;
+
+    for ( std::size_t i( 0 ); i != key_count; ++i )
+      {
+        const std::uint32_t k( next[ partition_of[ i ] ] );
+        ++next[ partition_of[ i ] ];
+        partition_hashes[ k ] = hashes[ i ];
+        partition_codes[ k ] = codes[ i ];
+      }
+  }
+
+  const header h =
+    {
+      g_perfect_hash_magic, seed, key_count, partition_count, first_bucket,
+      first_remap
+    };
+
+  const std::size_t header_words( word_count< header >( 1 ) );
+  const std::size_t partitions_words
+    ( word_count< partition >( partition_count ) );
+  const std::size_t pilots_words( word_count< std::uint16_t >( h.buckets ) );
+  const std::size_t remap_words( word_count< std::uint32_t >( h.remapped ) );
+
+  m_image.assign
+    ( header_words + partitions_words + pilots_words + remap_words
+      + key_count, 0 );
+
+  std::uint64_t* w( m_image.data() );
+  *reinterpret_cast< header* >( w ) = h;
+  w += header_words;
+  partition* const image_partitions( reinterpret_cast< partition* >( w ) );
+  std::copy( partitions.begin(), partitions.end(), image_partitions );
+  w += partitions_words;
+  std::uint16_t* const pilots( reinterpret_cast< std::uint16_t* >( w ) );
+  w += pilots_words;
+  std::uint32_t* const remap( reinterpret_cast< std::uint32_t* >( w ) );
+  w += remap_words;
+  std::uint64_t* const sorted_codes( w );
+
+  // The partitions are independent, each thread takes the next one.
+  std::atomic< std::size_t > next_partition( 0 );
+  std::vector< std::thread > workers;
+
+  for ( std::size_t t( 0 ); t != threads; ++t )
+    workers.emplace_back
+      ( [ & ]() -> void
+        {
+          for ( std::size_t i( next_partition++ ); i < partition_count;
+                i = next_partition++ )
+            {
+              partition& p( image_partitions[ i ] );
+
+              while ( !build_partition
+                      ( p, &partition_hashes[ p.first_key ],
+                        &partition_codes[ p.first_key ],
+                        pilots + p.first_bucket, remap + p.first_remap,
+                        sorted_codes + p.first_key ) )
+                ++p.seed;
+            }
+        } );
+
+  for ( std::thread& t : workers )
+    t.join();
+
+  return attach( m_image.data(), m_image.size() );
+}
@@ -0,0 +1,96 @@
+#include "query_log.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+bool read_query_log( query_log& result, std::istream& input )
+{
+  result.queries.clear();
+  result.times.clear();
+
+  std::string line;
+  std::size_t line_number( 0 );
+  double first( 0 );
+  double previous( 0 );
+  
+  while ( std::getline( input, line ) )
+    {
+      ++line_number;
+      
+      std::istringstream fields( line );
+      std::string a;
+      std::string b;
+      std::string extra;
+
+      if ( !( fields >> a ) )
+        continue;
+
+      fields >> b >> extra;
+
+      const bool timed( !b.empty() );
+      const char* error( nullptr );
+      
+      if ( !extra.empty() )
+        error = "too many fields";
+      else if ( !result.queries.empty()
+                && ( timed != !result.times.empty() ) )
+        error = "the lines must all have a timestamp or none of them";
+      else if ( !timed )
+        result.queries.push_back( a );
+      else
+        {
+          char* end;
+          const double seconds( std::strtod( a.c_str(), &end ) );
+
+          if ( ( *end != 0 ) || !std::isfinite( seconds ) )
+            error = "invalid timestamp";
+          else if ( result.times.empty() )
+            first = previous = seconds;
+          else if ( seconds < previous )
+            error = "the timestamps must not decrease";
+
+          if ( error == nullptr )
+            {
+              previous = seconds;
+              result.queries.push_back( b );
+              result.times.push_back( ( seconds - first ) * 1e9 );
+            }
+        }
+
+      if ( error != nullptr )
+        {
+          std::cerr << "Invalid query log, line " << line_number << ": "
+                    << error << ".\n";
+          return false;
+        }
+    }
+
+  return true;
+}
+
+bool parse_replay_timing( replay_timing& result, const char* name )
+{
+  if ( std::strcmp( name, "asap" ) == 0 )
+    result = replay_timing::as_fast_as_possible;
+  else if ( std::strcmp( name, "recorded" ) == 0 )
+    result = replay_timing::recorded;
+  else
+    return false;
+
+  return true;
+}
+
+const char* replay_timing_name( replay_timing timing )
+{
+  switch ( timing )
+    {
+    case replay_timing::as_fast_as_possible:
+      return "asap";
+    case replay_timing::recorded:
+      return "recorded";
+    }
+
+  return "unknown";
+}
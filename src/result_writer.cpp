@@ -0,0 +1,1116 @@
+#include "result_writer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <sstream>
+
+namespace
+{
+  class text_writer:
+    public result_writer
+  {
+  public:
+    explicit text_writer( std::ostream& output );
+    
+    void begin( const run_metadata& metadata ) override;
+    void encoders( const std::vector< encoder_result >& results ) override;
+    void engine
+    ( const std::string& tag, const bench_result& baseline,
+      const bench_result& result ) override;
+    void end() override;
+
+  private:
+    void output_counters
+    ( const std::string& tag, const char* direction, const char* region,
+      const perf_counters::sample& counters );
+    void output_counters
+    ( const std::string& tag, const char* direction,
+      const engine_result& result );
+    void output_stability
+    ( const std::string& tag, const char* direction,
+      const throughput_result& result );
+    void output_update_latency
+    ( const std::string& tag, const char* kind,
+      const latency_summary& latency );
+    void output_cold
+    ( const std::string& tag, const char* direction,
+      const latency_summary& latency );
+    void output_open_loop
+    ( const std::string& tag, const char* direction,
+      const open_loop_result& result );
+    
+  private:
+    std::ostream& m_output;
+    std::size_t m_key_count;
+  };
+
+  class json_writer:
+    public result_writer
+  {
+  public:
+    explicit json_writer( std::ostream& output );
+    
+    void begin( const run_metadata& metadata ) override;
+    void encoders( const std::vector< encoder_result >& results ) override;
+    void engine
+    ( const std::string& tag, const bench_result& baseline,
+      const bench_result& result ) override;
+    void end() override;
+
+  private:
+    void output_string( const std::string& s );
+    void output_number( double v );
+    void output_counters( const perf_counters::sample& counters );
+    void output_throughput( const throughput_result& result );
+    void output_latency( const latency_summary& latency );
+    void output_updates( const update_result& result );
+    void output_open_loop( const open_loop_result& result );
+    void output_engine_result( const engine_result& result );
+    
+  private:
+    std::ostream& m_output;
+    std::size_t m_key_count;
+    bool m_first_engine;
+
+    /** The speed of the encoders, printed after the engines. */
+    std::vector< encoder_result > m_encoders;
+  };
+
+  class csv_writer:
+    public result_writer
+  {
+  public:
+    explicit csv_writer( std::ostream& output );
+    
+    void begin( const run_metadata& metadata ) override;
+    void encoders( const std::vector< encoder_result >& results ) override;
+    void engine
+    ( const std::string& tag, const bench_result& baseline,
+      const bench_result& result ) override;
+    void end() override;
+
+  private:
+    void output_string( const std::string& s );
+    void row
+    ( const std::string& engine, const std::string& direction,
+      const std::string& metric, const std::string& length,
+      std::size_t threads, double value );
+    void row
+    ( const std::string& metric, const std::string& value );
+    void output_counters
+    ( const std::string& tag, const char* direction, const char* region,
+      const perf_counters::sample& counters );
+    void output_throughput
+    ( const std::string& tag, const char* direction,
+      const std::string& prefix, const char* region,
+      const throughput_result& result );
+    void output_engine_result
+    ( const std::string& tag, const char* direction,
+      const engine_result& result );
+    void output_update_latency
+    ( const std::string& tag, const char* kind,
+      const latency_summary& latency );
+    void output_open_loop
+    ( const std::string& tag, const char* direction,
+      const open_loop_result& result );
+    
+  private:
+    std::ostream& m_output;
+    std::size_t m_key_count;
+  };
+}
+
+static double bytes_per_key( std::size_t bytes, std::size_t key_count )
+{
+  return (double)bytes / std::max< std::size_t >( 1, key_count );
+}
+
+static bool has_counters( const perf_counters::sample& counters )
+{
+  return std::any_of
+    ( counters.begin(), counters.end(),
+      []( double v ) -> bool
+      {
+        return v >= 0;
+      } );
+}
+
+static double median_or_one( const latency_summary& latency )
+{
+  return ( latency.samples == 0 ) ? 1 : latency.p50;
+}
+
+/** The lengths of a bucket as "length", "min-max" or "min+". */
+static std::string length_label( const length_bucket& bucket )
+{
+  if ( bucket.min_length == bucket.max_length )
+    return std::to_string( bucket.min_length );
+
+  if ( bucket.max_length == std::numeric_limits< std::size_t >::max() )
+    return std::to_string( bucket.min_length ) + '+';
+
+  return std::to_string( bucket.min_length ) + '-'
+    + std::to_string( bucket.max_length );
+}
+
+text_writer::text_writer( std::ostream& output )
+  : m_output( output ),
+    m_key_count( 0 )
+{
+
+}
+
+void text_writer::begin( const run_metadata& metadata )
+{
+  m_key_count = metadata.key_count;
+}
+
+void text_writer::encoders( const std::vector< encoder_result >& results )
+{
+  for ( const encoder_result& r : results )
+    m_output << "encode\t" << r.ns_per_word << "\t+-" << r.ci << '\t'
+             << r.invalid << "\t# " << r.name << '\n';
+}
+
+void text_writer::engine
+( const std::string& tag, const bench_result& baseline,
+  const bench_result& result )
+{
+  // All the engines are measured with the same needles, thus the buckets are
+  // the same for the baseline and the result.
+  for ( std::size_t i( 0 ); i != result.forward.per_length.size(); ++i )
+    m_output << length_label( result.forward.per_length[ i ] ) << '\t'
+             << (float)median_or_one( baseline.forward.per_length[ i ].latency )
+                / median_or_one( result.forward.per_length[ i ].latency )
+             << '\t'
+             << (float)median_or_one( baseline.reverse.per_length[ i ].latency )
+                / median_or_one( result.reverse.per_length[ i ].latency )
+             << '\t'
+             << "# " << tag << '\n';
+
+  if ( result.forward.throughput.ns_per_lookup != 0 )
+    m_output << "throughput\t"
+             << result.forward.throughput.lookups_per_second << '\t'
+             << result.forward.throughput.ns_per_lookup << '\t'
+             << result.reverse.throughput.lookups_per_second << '\t'
+             << result.reverse.throughput.ns_per_lookup << '\t'
+             << "# " << tag << '\n';
+
+  if ( result.forward.throughput.ns_per_lookup != 0 )
+    {
+      output_stability( tag, "forward", result.forward.throughput );
+      output_stability( tag, "reverse", result.reverse.throughput );
+    }
+
+  if ( result.forward.contended.ns_per_lookup != 0 )
+    m_output << "contended\t"
+             << result.forward.contended.lookups_per_second << '\t'
+             << result.forward.contended.ns_per_lookup << '\t'
+             << result.reverse.contended.lookups_per_second << '\t'
+             << result.reverse.contended.ns_per_lookup << '\t'
+             << "# " << tag << '\n';
+
+  if ( result.forward.batched.ns_per_lookup != 0 )
+    m_output << "batched\t"
+             << result.forward.batched.lookups_per_second << '\t'
+             << result.forward.batched.ns_per_lookup << '\t'
+             << result.reverse.batched.lookups_per_second << '\t'
+             << result.reverse.batched.ns_per_lookup << '\t'
+             << "# " << tag << '\n';
+
+  output_cold( tag, "forward", result.forward.cold );
+  output_cold( tag, "reverse", result.reverse.cold );
+  output_open_loop( tag, "forward", result.forward.open_loop );
+  output_open_loop( tag, "reverse", result.reverse.open_loop );
+  
+  const footprint& memory( result.build.memory );
+  
+  if ( allocation_tracking_available() )
+    m_output << "memory\t" << memory.allocated << '\t'
+             << (float)bytes_per_key( memory.allocated, m_key_count ) << '\t'
+             << memory.resident << '\t'
+             << result.build.reported_size << '\t'
+             << "# " << tag << '\n';
+
+  m_output << "build\t" << result.build.duration << '\t' << memory.peak
+           << '\t'
+           << "# " << tag << '\n';
+
+  for ( const load_result& load : result.load )
+    m_output << "load\t" << load.method << '\t' << load.duration << '\t'
+             << load.file_size << '\t'
+             << "# " << tag << '\n';
+  
+  output_counters( tag, "forward", result.forward );
+  output_counters( tag, "reverse", result.reverse );
+
+  if ( result.workload.ns_per_lookup != 0 )
+    {
+      m_output << "workload\t" << result.workload.lookups_per_second << '\t'
+               << result.workload.ns_per_lookup << '\t'
+               << "# " << tag << '\n';
+      output_stability( tag, "workload", result.workload );
+      output_counters
+        ( tag, "workload", "throughput", result.workload.counters );
+    }
+  
+  if ( result.prefixes.throughput.ns_per_lookup != 0 )
+    {
+      m_output << "prefixes\t"
+               << result.prefixes.throughput.lookups_per_second << '\t'
+               << result.prefixes.throughput.ns_per_lookup << '\t'
+               << result.prefixes.hits << '\t'
+               << "# " << tag << '\n';
+      output_stability( tag, "prefixes", result.prefixes.throughput );
+    }
+  
+  if ( result.replay.queries_per_second != 0 )
+    m_output << "replay\t" << result.replay.queries_per_second << '\t'
+             << result.replay.hit_rate << '\t' << result.replay.latency.p50
+             << '\t' << result.replay.latency.p99 << '\t'
+             << result.replay.latency.p999 << '\t'
+             << result.replay.latency.max << '\t'
+             << "# " << tag << '\n';
+  
+  if ( result.updates.operations_per_second != 0 )
+    {
+      m_output << "updates\t" << result.updates.operations_per_second << '\t'
+               << result.updates.spikes << '\t'
+               << "# " << tag << '\n';
+      output_update_latency( tag, "contains", result.updates.contains );
+      output_update_latency( tag, "insert", result.updates.insert );
+      output_update_latency( tag, "erase", result.updates.erase );
+    }
+  
+  for ( std::size_t i( 0 ); i != result.forward.scaling.size(); ++i )
+    m_output << "scaling\t" << result.forward.scaling[ i ].threads << '\t'
+             << result.forward.scaling[ i ].lookups_per_second << '\t'
+             << result.forward.scaling[ i ].p99 << '\t'
+             << result.reverse.scaling[ i ].lookups_per_second << '\t'
+             << result.reverse.scaling[ i ].p99 << '\t'
+             << "# " << tag << '\n';
+}
+
+void text_writer::end()
+{
+
+}
+
+void text_writer::output_counters
+( const std::string& tag, const char* direction, const char* region,
+  const perf_counters::sample& counters )
+{
+  if ( !has_counters( counters ) )
+    return;
+
+  m_output << "counters\t" << direction << '\t' << region;
+
+  for ( std::size_t i( 0 ); i != perf_counters::counter_count; ++i )
+    {
+      m_output << '\t'
+               << perf_counters::name( perf_counters::counter( i ) ) << '=';
+
+      if ( counters[ i ] < 0 )
+        m_output << '-';
+      else
+        m_output << counters[ i ];
+    }
+
+  m_output << "\t# " << tag << '\n';
+}
+
+void text_writer::output_counters
+( const std::string& tag, const char* direction, const engine_result& result )
+{
+  output_counters( tag, direction, "repeat", result.counters );
+  output_counters( tag, direction, "throughput", result.throughput.counters );
+  output_counters( tag, direction, "contended", result.contended.counters );
+
+  if ( result.batched.ns_per_lookup != 0 )
+    output_counters( tag, direction, "batched", result.batched.counters );
+}
+
+void text_writer::output_stability
+( const std::string& tag, const char* direction,
+  const throughput_result& result )
+{
+  m_output << "stability\t" << direction << '\t' << result.ns_per_lookup
+           << "\t+-" << result.ci << '\t' << result.batches << '\t'
+           << result.cv;
+
+  if ( result.frequency_changed )
+    m_output << "\tfrequency-changed";
+
+  if ( result.noisy )
+    m_output << "\tnoisy";
+
+  m_output << "\t# " << tag << '\n';
+}
+
+void text_writer::output_update_latency
+( const std::string& tag, const char* kind, const latency_summary& latency )
+{
+  if ( latency.samples == 0 )
+    return;
+
+  m_output << "update-latency\t" << kind << '\t' << latency.p50 << '\t'
+           << latency.p99 << '\t' << latency.p999 << '\t' << latency.max
+           << "\t# " << tag << '\n';
+}
+
+void text_writer::output_cold
+( const std::string& tag, const char* direction,
+  const latency_summary& latency )
+{
+  if ( latency.samples == 0 )
+    return;
+
+  m_output << "cold\t" << direction << '\t' << latency.p50 << '\t'
+           << latency.p90 << '\t' << latency.p99 << '\t' << latency.max
+           << "\t# " << tag << '\n';
+}
+
+void text_writer::output_open_loop
+( const std::string& tag, const char* direction,
+  const open_loop_result& result )
+{
+  if ( result.points.empty() )
+    return;
+
+  for ( const open_loop_point& p : result.points )
+    m_output << "open-loop\t" << direction << '\t' << p.target_qps << '\t'
+             << p.achieved_qps << '\t' << p.latency.p50 << '\t'
+             << p.latency.p99 << '\t' << p.latency.p999 << '\t'
+             << p.latency.max << "\t# " << tag << '\n';
+
+  m_output << "knee\t" << direction << '\t' << result.knee_qps << "\t# "
+           << tag << '\n';
+}
+
+json_writer::json_writer( std::ostream& output )
+  : m_output( output ),
+    m_key_count( 0 ),
+    m_first_engine( true )
+{
+
+}
+
+void json_writer::begin( const run_metadata& metadata )
+{
+  m_key_count = metadata.key_count;
+  
+  m_output << "{\n  \"metadata\": {\n    \"compiler\": ";
+  output_string( metadata.compiler );
+  m_output << ",\n    \"flags\": ";
+  output_string( metadata.flags );
+  m_output << ",\n    \"cpu_model\": ";
+  output_string( metadata.cpu_model );
+  m_output << ",\n    \"runs\": " << metadata.runs
+           << ",\n    \"key_count\": " << metadata.key_count
+           << ",\n    \"corpus_hash\": \"" << std::hex << std::setw( 16 )
+           << std::setfill( '0' ) << metadata.corpus_hash << std::dec
+           << std::setfill( ' ' ) << '"'
+           << ",\n    \"seed\": " << metadata.seed
+           << ",\n    \"throughput_queries\": " << metadata.throughput_queries
+           << ",\n    \"cpu\": ";
+
+  if ( metadata.cpu < 0 )
+    m_output << "null";
+  else
+    m_output << metadata.cpu;
+
+  m_output << ",\n    \"huge_pages\": ";
+  output_string( huge_page_mode_name( metadata.huge_pages ) );
+
+  m_output << ",\n    \"threads\": " << metadata.threads
+           << ",\n    \"cold_lookups\": " << metadata.cold_lookups
+           << ",\n    \"noisy_neighbors\": " << metadata.noisy_neighbors
+           << ",\n    \"open_loop_requests\": "
+           << metadata.open_loop_requests
+           << ",\n    \"open_loop_threads\": " << metadata.open_loop_threads
+           << ",\n    \"last_level_cache\": " << metadata.last_level_cache
+           << ",\n    \"workload_queries\": " << metadata.workload_queries
+           << ",\n    \"prefix_queries\": " << metadata.prefix_queries
+           << ",\n    \"batch_size\": " << metadata.batch_size
+           << ",\n    \"max_load_factor\": " << metadata.max_load_factor
+           << ",\n    \"update_operations\": " << metadata.update_operations
+           << ",\n    \"replay_queries\": " << metadata.replay_queries
+           << ",\n    \"replay_timing\": ";
+  output_string( replay_timing_name( metadata.replay_mode ) );
+  m_output << "\n  },\n  \"engines\": [";
+}
+
+void json_writer::encoders( const std::vector< encoder_result >& results )
+{
+  m_encoders = results;
+}
+
+void json_writer::engine
+( const std::string& tag, const bench_result& baseline,
+  const bench_result& result )
+{
+  if ( !m_first_engine )
+    m_output << ',';
+
+  m_first_engine = false;
+  
+  const footprint& memory( result.build.memory );
+
+  m_output << "\n    {\n      \"name\": ";
+  output_string( tag );
+  m_output << ",\n      \"build\": { \"ns\": " << result.build.duration
+           << ", \"peak_bytes\": " << memory.peak << " }";
+
+  if ( allocation_tracking_available() )
+    m_output << ",\n      \"memory\": { \"allocated_bytes\": "
+             << memory.allocated << ", \"bytes_per_key\": "
+             << bytes_per_key( memory.allocated, m_key_count )
+             << ", \"resident_bytes\": " << memory.resident
+             << ", \"reported_bytes\": " << result.build.reported_size
+             << " }";
+
+  m_output << ",\n      \"load\": [";
+
+  for ( std::size_t i( 0 ); i != result.load.size(); ++i )
+    {
+      if ( i != 0 )
+        m_output << ',';
+
+      m_output << " { \"method\": ";
+      output_string( result.load[ i ].method );
+      m_output << ", \"ns\": " << result.load[ i ].duration
+               << ", \"file_bytes\": " << result.load[ i ].file_size << " }";
+    }
+
+  m_output << " ],\n      \"forward\": ";
+  output_engine_result( result.forward );
+  m_output << ",\n      \"reverse\": ";
+  output_engine_result( result.reverse );
+  m_output << ",\n      \"workload\": ";
+
+  if ( result.workload.ns_per_lookup == 0 )
+    m_output << "null";
+  else
+    output_throughput( result.workload );
+
+  m_output << ",\n      \"prefixes\": ";
+
+  if ( result.prefixes.throughput.ns_per_lookup == 0 )
+    m_output << "null";
+  else
+    {
+      m_output << "{ \"hits\": " << result.prefixes.hits
+               << ", \"throughput\": ";
+      output_throughput( result.prefixes.throughput );
+      m_output << " }";
+    }
+
+  m_output << ",\n      \"replay\": ";
+
+  if ( result.replay.queries_per_second == 0 )
+    m_output << "null";
+  else
+    {
+      m_output << "{ \"queries_per_second\": ";
+      output_number( result.replay.queries_per_second );
+      m_output << ", \"hit_rate\": ";
+      output_number( result.replay.hit_rate );
+      m_output << ", \"latency\": ";
+      output_latency( result.replay.latency );
+      m_output << " }";
+    }
+  
+  m_output << ",\n      \"updates\": ";
+
+  if ( result.updates.operations_per_second == 0 )
+    m_output << "null";
+  else
+    output_updates( result.updates );
+  
+  m_output << "\n    }";
+}
+
+void json_writer::end()
+{
+  m_output << "\n  ],\n  \"encoders\": [";
+
+  for ( std::size_t i( 0 ); i != m_encoders.size(); ++i )
+    {
+      if ( i != 0 )
+        m_output << ',';
+
+      m_output << "\n    { \"name\": ";
+      output_string( m_encoders[ i ].name );
+      m_output << ", \"ns_per_word\": ";
+      output_number( m_encoders[ i ].ns_per_word );
+      m_output << ", \"ci\": ";
+      output_number( m_encoders[ i ].ci );
+      m_output << ", \"invalid\": " << m_encoders[ i ].invalid << " }";
+    }
+
+  m_output << " ]\n}\n";
+}
+
+void json_writer::output_string( const std::string& s )
+{
+  m_output << '"';
+
+  for ( char c : s )
+    if ( ( c == '"' ) || ( c == '\\' ) )
+      m_output << '\\' << c;
+    else if ( (unsigned char)c < 0x20 )
+      m_output << ' ';
+    else
+      m_output << c;
+
+  m_output << '"';
+}
+
+void json_writer::output_number( double v )
+{
+  if ( std::isfinite( v ) )
+    m_output << v;
+  else
+    m_output << "null";
+}
+
+void json_writer::output_counters( const perf_counters::sample& counters )
+{
+  if ( !has_counters( counters ) )
+    {
+      m_output << "null";
+      return;
+    }
+
+  m_output << '{';
+  
+  for ( std::size_t i( 0 ); i != perf_counters::counter_count; ++i )
+    {
+      if ( i != 0 )
+        m_output << ',';
+
+      m_output << ' ';
+      output_string( perf_counters::name( perf_counters::counter( i ) ) );
+      m_output << ": ";
+
+      if ( counters[ i ] < 0 )
+        m_output << "null";
+      else
+        output_number( counters[ i ] );
+    }
+
+  m_output << " }";
+}
+
+void json_writer::output_throughput( const throughput_result& result )
+{
+  m_output << "{ \"lookups_per_second\": ";
+  output_number( result.lookups_per_second );
+  m_output << ", \"ns_per_lookup\": ";
+  output_number( result.ns_per_lookup );
+  m_output << ", \"ci_ns\": ";
+  output_number( result.ci );
+  m_output << ", \"batches\": " << result.batches << ", \"cv\": ";
+  output_number( result.cv );
+  m_output << ", \"frequency_changed\": "
+           << ( result.frequency_changed ? "true" : "false" )
+           << ", \"noisy\": " << ( result.noisy ? "true" : "false" )
+           << ", \"counters\": ";
+  output_counters( result.counters );
+  m_output << " }";
+}
+
+void json_writer::output_latency( const latency_summary& latency )
+{
+  if ( latency.samples == 0 )
+    {
+      m_output << "null";
+      return;
+    }
+
+  m_output << "{ \"samples\": " << latency.samples << ", \"p50\": ";
+  output_number( latency.p50 );
+  m_output << ", \"p90\": ";
+  output_number( latency.p90 );
+  m_output << ", \"p99\": ";
+  output_number( latency.p99 );
+  m_output << ", \"p99.9\": ";
+  output_number( latency.p999 );
+  m_output << ", \"max\": ";
+  output_number( latency.max );
+  m_output << " }";
+}
+
+void json_writer::output_updates( const update_result& result )
+{
+  m_output << "{ \"operations_per_second\": ";
+  output_number( result.operations_per_second );
+  m_output << ", \"spikes\": " << result.spikes
+           << ",\n        \"contains\": ";
+  output_latency( result.contains );
+  m_output << ",\n        \"insert\": ";
+  output_latency( result.insert );
+  m_output << ",\n        \"erase\": ";
+  output_latency( result.erase );
+  m_output << " }";
+}
+
+void json_writer::output_engine_result( const engine_result& result )
+{
+  m_output << "{\n        \"latency\": [";
+
+  bool first( true );
+  
+  for ( const length_bucket& bucket : result.per_length )
+    {
+      const latency_summary& latency( bucket.latency );
+
+      if ( !first )
+        m_output << ',';
+
+      first = false;
+      
+      m_output << "\n          { \"min_length\": " << bucket.min_length
+               << ", \"max_length\": ";
+
+      if ( bucket.max_length == std::numeric_limits< std::size_t >::max() )
+        m_output << "null";
+      else
+        m_output << bucket.max_length;
+      
+      m_output << ", \"samples\": " << latency.samples
+               << ", \"p50\": ";
+      output_number( latency.p50 );
+      m_output << ", \"p90\": ";
+      output_number( latency.p90 );
+      m_output << ", \"p99\": ";
+      output_number( latency.p99 );
+      m_output << ", \"p99.9\": ";
+      output_number( latency.p999 );
+      m_output << ", \"max\": ";
+      output_number( latency.max );
+      m_output << " }";
+    }
+  
+  m_output << " ],\n        \"counters\": ";
+  output_counters( result.counters );
+  m_output << ",\n        \"throughput\": ";
+
+  if ( result.throughput.ns_per_lookup == 0 )
+    m_output << "null";
+  else
+    output_throughput( result.throughput );
+
+  m_output << ",\n        \"scaling\": [";
+
+  for ( std::size_t i( 0 ); i != result.scaling.size(); ++i )
+    {
+      if ( i != 0 )
+        m_output << ',';
+
+      m_output << " { \"threads\": " << result.scaling[ i ].threads
+               << ", \"lookups_per_second\": ";
+      output_number( result.scaling[ i ].lookups_per_second );
+      m_output << ", \"p99\": " << result.scaling[ i ].p99 << " }";
+    }
+
+  m_output << " ],\n        \"contended\": ";
+
+  if ( result.contended.ns_per_lookup == 0 )
+    m_output << "null";
+  else
+    output_throughput( result.contended );
+
+  m_output << ",\n        \"batched\": ";
+
+  if ( result.batched.ns_per_lookup == 0 )
+    m_output << "null";
+  else
+    output_throughput( result.batched );
+
+  m_output << ",\n        \"cold\": ";
+  output_latency( result.cold );
+  m_output << ",\n        \"open_loop\": ";
+  output_open_loop( result.open_loop );
+  m_output << "\n      }";
+}
+
+void json_writer::output_open_loop( const open_loop_result& result )
+{
+  if ( result.points.empty() )
+    {
+      m_output << "null";
+      return;
+    }
+
+  m_output << "{ \"knee_qps\": ";
+  output_number( result.knee_qps );
+  m_output << ", \"points\": [";
+
+  for ( std::size_t i( 0 ); i != result.points.size(); ++i )
+    {
+      if ( i != 0 )
+        m_output << ',';
+
+      m_output << "\n          { \"target_qps\": ";
+      output_number( result.points[ i ].target_qps );
+      m_output << ", \"achieved_qps\": ";
+      output_number( result.points[ i ].achieved_qps );
+      m_output << ", \"latency\": ";
+      output_latency( result.points[ i ].latency );
+      m_output << " }";
+    }
+
+  m_output << " ] }";
+}
+
+csv_writer::csv_writer( std::ostream& output )
+  : m_output( output ),
+    m_key_count( 0 )
+{
+
+}
+
+void csv_writer::begin( const run_metadata& metadata )
+{
+  m_key_count = metadata.key_count;
+
+  m_output << "engine,direction,metric,length,threads,value\n";
+
+  row( "compiler", metadata.compiler );
+  row( "flags", metadata.flags );
+  row( "cpu_model", metadata.cpu_model );
+  row( "runs", std::to_string( metadata.runs ) );
+  row( "key_count", std::to_string( metadata.key_count ) );
+
+  char hash[ 17 ];
+  std::snprintf
+    ( hash, sizeof( hash ), "%016llx",
+      (unsigned long long)metadata.corpus_hash );
+  row( "corpus_hash", hash );
+  
+  row( "seed", std::to_string( metadata.seed ) );
+  row( "throughput_queries", std::to_string( metadata.throughput_queries ) );
+  row
+    ( "cpu",
+      ( metadata.cpu < 0 ) ? std::string() : std::to_string( metadata.cpu ) );
+  row( "huge_pages", huge_page_mode_name( metadata.huge_pages ) );
+  row( "threads", std::to_string( metadata.threads ) );
+  row( "cold_lookups", std::to_string( metadata.cold_lookups ) );
+  row( "noisy_neighbors", std::to_string( metadata.noisy_neighbors ) );
+  row
+    ( "open_loop_requests", std::to_string( metadata.open_loop_requests ) );
+  row( "open_loop_threads", std::to_string( metadata.open_loop_threads ) );
+  row( "last_level_cache", std::to_string( metadata.last_level_cache ) );
+  row( "workload_queries", std::to_string( metadata.workload_queries ) );
+  row( "prefix_queries", std::to_string( metadata.prefix_queries ) );
+  row( "batch_size", std::to_string( metadata.batch_size ) );
+
+  std::ostringstream load_factor;
+  load_factor << metadata.max_load_factor;
+  row( "max_load_factor", load_factor.str() );
+  row( "update_operations", std::to_string( metadata.update_operations ) );
+  row( "replay_queries", std::to_string( metadata.replay_queries ) );
+  row( "replay_timing", replay_timing_name( metadata.replay_mode ) );
+}
+
+void csv_writer::encoders( const std::vector< encoder_result >& results )
+{
+  for ( const encoder_result& r : results )
+    {
+      row( "encoder", r.name, "ns_per_word", "", 0, r.ns_per_word );
+      row( "encoder", r.name, "ci_ns", "", 0, r.ci );
+      row( "encoder", r.name, "invalid", "", 0, r.invalid );
+    }
+}
+
+void csv_writer::engine
+( const std::string& tag, const bench_result& baseline,
+  const bench_result& result )
+{
+  const footprint& memory( result.build.memory );
+
+  row( tag, "", "build_ns", "", 0, result.build.duration );
+  row( tag, "", "build_peak_bytes", "", 0, memory.peak );
+
+  if ( allocation_tracking_available() )
+    {
+      row( tag, "", "allocated_bytes", "", 0, memory.allocated );
+      row
+        ( tag, "", "bytes_per_key", "", 0,
+          bytes_per_key( memory.allocated, m_key_count ) );
+      row( tag, "", "resident_bytes", "", 0, memory.resident );
+      row( tag, "", "reported_bytes", "", 0, result.build.reported_size );
+    }
+
+  for ( const load_result& load : result.load )
+    {
+      row( tag, load.method, "load_ns", "", 0, load.duration );
+      row( tag, load.method, "file_bytes", "", 0, load.file_size );
+    }
+
+  output_engine_result( tag, "forward", result.forward );
+  output_engine_result( tag, "reverse", result.reverse );
+
+  if ( result.workload.ns_per_lookup != 0 )
+    output_throughput
+      ( tag, "workload", "", "throughput", result.workload );
+
+  if ( result.prefixes.throughput.ns_per_lookup != 0 )
+    {
+      output_throughput
+        ( tag, "prefixes", "", "throughput", result.prefixes.throughput );
+      row( tag, "prefixes", "hits", "", 0, result.prefixes.hits );
+    }
+  
+  if ( result.replay.queries_per_second != 0 )
+    {
+      const latency_summary& latency( result.replay.latency );
+      
+      row
+        ( tag, "replay", "queries_per_second", "", 0,
+          result.replay.queries_per_second );
+      row( tag, "replay", "hit_rate", "", 0, result.replay.hit_rate );
+      row( tag, "replay", "p50_ns", "", 0, latency.p50 );
+      row( tag, "replay", "p90_ns", "", 0, latency.p90 );
+      row( tag, "replay", "p99_ns", "", 0, latency.p99 );
+      row( tag, "replay", "p99.9_ns", "", 0, latency.p999 );
+      row( tag, "replay", "max_ns", "", 0, latency.max );
+    }
+  
+  if ( result.updates.operations_per_second != 0 )
+    {
+      row
+        ( tag, "updates", "operations_per_second", "", 0,
+          result.updates.operations_per_second );
+      row( tag, "updates", "spikes", "", 0, result.updates.spikes );
+      output_update_latency( tag, "contains", result.updates.contains );
+      output_update_latency( tag, "insert", result.updates.insert );
+      output_update_latency( tag, "erase", result.updates.erase );
+    }
+}
+
+void csv_writer::end()
+{
+
+}
+
+void csv_writer::output_string( const std::string& s )
+{
+  if ( s.find_first_of( ",\"\n" ) == std::string::npos )
+    {
+      m_output << s;
+      return;
+    }
+
+  m_output << '"';
+
+  for ( char c : s )
+    if ( c == '"' )
+      m_output << "\"\"";
+    else
+      m_output << c;
+
+  m_output << '"';
+}
+
+void csv_writer::row
+( const std::string& engine, const std::string& direction,
+  const std::string& metric, const std::string& length, std::size_t threads,
+  double value )
+{
+  output_string( engine );
+  m_output << ',';
+  output_string( direction );
+  m_output << ',';
+  output_string( metric );
+  m_output << ',';
+
+  output_string( length );
+  m_output << ',';
+  
+  if ( threads != 0 )
+    m_output << threads;
+
+  m_output << ',';
+
+  // The counts and durations are printed as integers, the other values
+  // with all their digits, such that no precision is lost.
+  if ( std::isfinite( value ) )
+    {
+      if ( ( value == std::trunc( value ) ) && ( std::fabs( value ) < 9e18 ) )
+        m_output << (long long)value;
+      else
+        m_output
+          << std::setprecision( std::numeric_limits< double >::max_digits10 )
+          << value;
+    }
+
+  m_output << '\n';
+}
+
+void csv_writer::row( const std::string& metric, const std::string& value )
+{
+  m_output << "metadata,,";
+  output_string( metric );
+  m_output << ",,,";
+  output_string( value );
+  m_output << '\n';
+}
+
+void csv_writer::output_counters
+( const std::string& tag, const char* direction, const char* region,
+  const perf_counters::sample& counters )
+{
+  for ( std::size_t i( 0 ); i != perf_counters::counter_count; ++i )
+    if ( counters[ i ] >= 0 )
+      row
+        ( tag, direction,
+          std::string( region ) + '_'
+          + perf_counters::name( perf_counters::counter( i ) ),
+          "", 0, counters[ i ] );
+}
+
+/**
+ * Writes the rows of a throughput measure, whose metrics are prefixed with
+ * the given string and whose counters are in the given region.
+ */
+void csv_writer::output_throughput
+( const std::string& tag, const char* direction, const std::string& prefix,
+  const char* region, const throughput_result& result )
+{
+  row( tag, direction, prefix + "lookups_per_second", "", 0,
+       result.lookups_per_second );
+  row( tag, direction, prefix + "ns_per_lookup", "", 0, result.ns_per_lookup );
+  row( tag, direction, prefix + "ci_ns", "", 0, result.ci );
+  row( tag, direction, prefix + "batches", "", 0, result.batches );
+  row( tag, direction, prefix + "cv", "", 0, result.cv );
+  row
+    ( tag, direction, prefix + "frequency_changed", "", 0,
+      result.frequency_changed );
+  row( tag, direction, prefix + "noisy", "", 0, result.noisy );
+  output_counters( tag, direction, region, result.counters );
+}
+
+void csv_writer::output_engine_result
+( const std::string& tag, const char* direction, const engine_result& result )
+{
+  for ( const length_bucket& bucket : result.per_length )
+    {
+      const latency_summary& latency( bucket.latency );
+      const std::string length( length_label( bucket ) );
+
+      row( tag, direction, "p50_ns", length, 0, latency.p50 );
+      row( tag, direction, "p90_ns", length, 0, latency.p90 );
+      row( tag, direction, "p99_ns", length, 0, latency.p99 );
+      row( tag, direction, "p99.9_ns", length, 0, latency.p999 );
+      row( tag, direction, "max_ns", length, 0, latency.max );
+    }
+
+  output_counters( tag, direction, "repeat", result.counters );
+
+  if ( result.throughput.ns_per_lookup != 0 )
+    output_throughput
+      ( tag, direction, "", "throughput", result.throughput );
+
+  for ( const scaling_point& p : result.scaling )
+    {
+      row
+        ( tag, direction, "scaling_lookups_per_second", "", p.threads,
+          p.lookups_per_second );
+      row( tag, direction, "scaling_p99_ns", "", p.threads, p.p99 );
+    }
+
+  if ( result.contended.ns_per_lookup != 0 )
+    output_throughput
+      ( tag, direction, "contended_", "contended", result.contended );
+
+  if ( result.batched.ns_per_lookup != 0 )
+    output_throughput
+      ( tag, direction, "batched_", "batched", result.batched );
+
+  if ( result.cold.samples != 0 )
+    {
+      row( tag, direction, "cold_p50_ns", "", 0, result.cold.p50 );
+      row( tag, direction, "cold_p90_ns", "", 0, result.cold.p90 );
+      row( tag, direction, "cold_p99_ns", "", 0, result.cold.p99 );
+      row( tag, direction, "cold_max_ns", "", 0, result.cold.max );
+    }
+
+  output_open_loop( tag, direction, result.open_loop );
+}
+
+/**
+ * Writes the rows of the open loop test. The metrics of each step are
+ * prefixed with its target rate, e.g. open_loop_200000_p99_ns.
+ */
+void csv_writer::output_open_loop
+( const std::string& tag, const char* direction,
+  const open_loop_result& result )
+{
+  if ( result.points.empty() )
+    return;
+
+  for ( const open_loop_point& p : result.points )
+    {
+      char rate[ 32 ];
+      std::snprintf( rate, sizeof( rate ), "%.0f", p.target_qps );
+      const std::string prefix( std::string( "open_loop_" ) + rate + '_' );
+
+      row( tag, direction, prefix + "achieved_qps", "", 0, p.achieved_qps );
+      row( tag, direction, prefix + "p50_ns", "", 0, p.latency.p50 );
+      row( tag, direction, prefix + "p90_ns", "", 0, p.latency.p90 );
+      row( tag, direction, prefix + "p99_ns", "", 0, p.latency.p99 );
+      row( tag, direction, prefix + "p99.9_ns", "", 0, p.latency.p999 );
+      row( tag, direction, prefix + "max_ns", "", 0, p.latency.max );
+    }
+
+  row( tag, direction, "open_loop_knee_qps", "", 0, result.knee_qps );
+}
+
+void csv_writer::output_update_latency
+( const std::string& tag, const char* kind, const latency_summary& latency )
+{
+  if ( latency.samples == 0 )
+    return;
+
+  row( tag, kind, "update_p50_ns", "", 0, latency.p50 );
+  row( tag, kind, "update_p99_ns", "", 0, latency.p99 );
+  row( tag, kind, "update_p99.9_ns", "", 0, latency.p999 );
+  row( tag, kind, "update_max_ns", "", 0, latency.max );
+}
+
+bool parse_output_format( output_format& result, const char* name )
+{
+  if ( std::strcmp( name, "text" ) == 0 )
+    result = output_format::text;
+  else if ( std::strcmp( name, "json" ) == 0 )
+    result = output_format::json;
+  else if ( std::strcmp( name, "csv" ) == 0 )
+    result = output_format::csv;
+  else
+    return false;
+
+  return true;
+}
+
+result_writer::~result_writer() = default;
+
+std::unique_ptr< result_writer > make_result_writer
+( output_format format, std::ostream& output )
+{
+  switch ( format )
+    {
+    case output_format::json:
+      return std::unique_ptr< result_writer >( new json_writer( output ) );
+    case output_format::csv:
+      return std::unique_ptr< result_writer >( new csv_writer( output ) );
+    default:
+      return std::unique_ptr< result_writer >( new text_writer( output ) );
+    }
+}
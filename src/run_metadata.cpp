@@ -0,0 +1,60 @@
+#include "run_metadata.hpp"
+
+#include <fstream>
+
+std::string compiler_name()
+{
+#if defined( __clang__ )
+  return "clang++ " __clang_version__;
+#elif defined( __GNUC__ )
+  return "g++ " __VERSION__;
+#else
+  return "unknown";
+#endif
+}
+
+std::string compiler_flags()
+{
+#ifdef BENCH_FLAGS
+  return BENCH_FLAGS;
+#else
+  return "unknown";
+#endif
+}
+
+std::string cpu_model()
+{
+  std::ifstream f( "/proc/cpuinfo" );
+  std::string line;
+  
+  while ( std::getline( f, line ) )
+    if ( line.compare( 0, 10, "model name" ) == 0 )
+      {
+        const std::size_t colon( line.find( ':' ) );
+
+        if ( colon != std::string::npos )
+          return line.substr( line.find_first_not_of( ' ', colon + 1 ) );
+      }
+
+  return "unknown";
+}
+
+corpus_hasher::corpus_hasher()
+  : m_hash( 14695981039346656037ull )
+{
+
+}
+
+void corpus_hasher::add( const std::string& word )
+{
+  // The words are separated by a newline, as in the corpus file.
+  for ( char c : word )
+    m_hash = ( m_hash ^ (unsigned char)c ) * 1099511628211ull;
+
+  m_hash = ( m_hash ^ '\n' ) * 1099511628211ull;
+}
+
+std::uint64_t corpus_hasher::get() const
+{
+  return m_hash;
+}
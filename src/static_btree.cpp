@@ -0,0 +1,311 @@
+#include "static_btree.hpp"
+
+#include <algorithm>
+
+#if defined( __x86_64__ )
+  #define STATIC_BTREE_X86 1
+  #include <immintrin.h>
+#else
+  #define STATIC_BTREE_X86 0
+#endif
+
+/** The number of keys in a node, which has one more child. */
+static constexpr std::size_t node_keys( 16 );
+
+/** The number of 64-bit words in a cache line. */
+static constexpr std::size_t line_words( 8 );
+
+/**
+ * Flipping this bit of the codes keeps their order when they are compared
+ * as signed integers, which are the only ones AVX2 compares.
+ */
+static constexpr std::uint64_t sign_bit( std::uint64_t( 1 ) << 63 );
+
+/** The number of keys of the node lower than the flipped code. */
+static std::size_t node_rank_scalar
+( const std::uint64_t* node, std::int64_t code )
+{
+  std::size_t result( 0 );
+
+  for ( std::size_t i( 0 ); i != node_keys; ++i )
+    result += ( std::int64_t( node[ i ] ) < code );
+
+  return result;
+}
+
+/**
+ * The position in the lowest layer of the lowest key not lower than the
+ * flipped code, which is the number of keys lower than it.
+ */
+static std::size_t lower_bound_scalar
+( const std::uint64_t* keys, const std::vector< std::size_t >& layers,
+  std::int64_t code )
+{
+  std::size_t node( 0 );
+
+  for ( std::size_t h( layers.size() - 1 ); h != 0; --h )
+    node =
+      node * ( node_keys + 1 )
+      + node_rank_scalar( keys + layers[ h ] + node * node_keys, code );
+
+  return node * node_keys + node_rank_scalar( keys + node * node_keys, code );
+}
+
+/**
+ * Counts the codes found in the tree. The codes are searched by batches,
+ * layer after layer, and the nodes of the next layer are prefetched.
+ */
+static std::size_t count_scalar
+( const std::uint64_t* keys, const std::vector< std::size_t >& layers,
+  std::size_t size, const std::uint64_t* codes, std::size_t n )
+{
+  constexpr std::size_t batch_size( 16 );
+  std::int64_t batch[ batch_size ];
+  std::size_t nodes[ batch_size ];
+  std::size_t result( 0 );
+
+  for ( std::size_t first( 0 ); first < n; first += batch_size )
+    {
+      const std::size_t count( std::min( n - first, batch_size ) );
+
+      for ( std::size_t i( 0 ); i != count; ++i )
+        {
+          batch[ i ] = codes[ first + i ] ^ sign_bit;
+          nodes[ i ] = 0;
+        }
+
+      for ( std::size_t h( layers.size() - 1 ); h != 0; --h )
+        for ( std::size_t i( 0 ); i != count; ++i )
+          {
+            const std::size_t node
+              ( nodes[ i ] * ( node_keys + 1 )
+                + node_rank_scalar
+                ( keys + layers[ h ] + nodes[ i ] * node_keys, batch[ i ] ) );
+            const std::uint64_t* const child
+              ( keys + layers[ h - 1 ] + node * node_keys );
+
+            __builtin_prefetch( child );
+            __builtin_prefetch( child + line_words );
+            nodes[ i ] = node;
+          }
+
+      for ( std::size_t i( 0 ); i != count; ++i )
+        {
+          const std::size_t position
+            ( nodes[ i ] * node_keys
+              + node_rank_scalar
+              ( keys + nodes[ i ] * node_keys, batch[ i ] ) );
+
+          result +=
+            ( position < size )
+            & ( keys[ position ] == std::uint64_t( batch[ i ] ) );
+        }
+    }
+
+  return result;
+}
+
+#if STATIC_BTREE_X86
+
+/** The number of keys of the node lower than the flipped code. */
+__attribute__(( target( "avx2,popcnt" ) ))
+static inline std::size_t node_rank_avx2
+( const std::uint64_t* node, __m256i code )
+{
+  const __m256i* const vectors( reinterpret_cast< const __m256i* >( node ) );
+  int lower( 0 );
+
+  for ( std::size_t i( 0 ); i != node_keys / 4; ++i )
+    lower |=
+      _mm256_movemask_pd
+      ( _mm256_castsi256_pd
+        ( _mm256_cmpgt_epi64( code, _mm256_load_si256( vectors + i ) ) ) )
+      << ( 4 * i );
+
+  return __builtin_popcount( lower );
+}
+
+/** See lower_bound_scalar(). */
+__attribute__(( target( "avx2,popcnt" ) ))
+static std::size_t lower_bound_avx2
+( const std::uint64_t* keys, const std::vector< std::size_t >& layers,
+  std::int64_t code )
+{
+  const __m256i broadcast( _mm256_set1_epi64x( code ) );
+  std::size_t node( 0 );
+
+  for ( std::size_t h( layers.size() - 1 ); h != 0; --h )
+    node =
+      node * ( node_keys + 1 )
+      + node_rank_avx2( keys + layers[ h ] + node * node_keys, broadcast );
+
+  return
+    node * node_keys + node_rank_avx2( keys + node * node_keys, broadcast );
+}
+
+/** See count_scalar(). */
+__attribute__(( target( "avx2,popcnt" ) ))
+static std::size_t count_avx2
+( const std::uint64_t* keys, const std::vector< std::size_t >& layers,
+  std::size_t size, const std::uint64_t* codes, std::size_t n )
+{
+  constexpr std::size_t batch_size( 16 );
+  __m256i batch[ batch_size ];
+  std::size_t nodes[ batch_size ];
+  std::size_t result( 0 );
+
+  for ( std::size_t first( 0 ); first < n; first += batch_size )
+    {
+      const std::size_t count( std::min( n - first, batch_size ) );
+
+      for ( std::size_t i( 0 ); i != count; ++i )
+        {
+          batch[ i ] = _mm256_set1_epi64x( codes[ first + i ] ^ sign_bit );
+          nodes[ i ] = 0;
+        }
+
+      for ( std::size_t h( layers.size() - 1 ); h != 0; --h )
+        for ( std::size_t i( 0 ); i != count; ++i )
+          {
+            const std::size_t node
+              ( nodes[ i ] * ( node_keys + 1 )
+                + node_rank_avx2
+                ( keys + layers[ h ] + nodes[ i ] * node_keys, batch[ i ] ) );
+            const std::uint64_t* const child
+              ( keys + layers[ h - 1 ] + node * node_keys );
+
+            __builtin_prefetch( child );
+            __builtin_prefetch( child + line_words );
+            nodes[ i ] = node;
+          }
+
+      for ( std::size_t i( 0 ); i != count; ++i )
+        {
+          const std::size_t position
+            ( nodes[ i ] * node_keys
+              + node_rank_avx2( keys + nodes[ i ] * node_keys, batch[ i ] ) );
+
+          result +=
+            ( position < size )
+            & ( keys[ position ] == ( codes[ first + i ] ^ sign_bit ) );
+        }
+    }
+
+  return result;
+}
+
+#endif
+
+static bool avx2_supported()
+{
+#if STATIC_BTREE_X86
+  return __builtin_cpu_supports( "avx2" )
+    && __builtin_cpu_supports( "popcnt" );
+#else
+  return false;
+#endif
+}
+
+static_btree::static_btree()
+  : m_keys( nullptr ),
+    m_size( 0 ),
+    m_avx2( avx2_supported() )
+{
+  build( std::vector< std::uint64_t >() );
+}
+
+void static_btree::build( std::vector< std::uint64_t > codes )
+{
+  std::sort( codes.begin(), codes.end() );
+  codes.erase( std::unique( codes.begin(), codes.end() ), codes.end() );
+
+  m_size = codes.size();
+
+  // The lowest layer has at least one padding key, not lower than any
+  // code, such that the position of a code is always a valid one.
+  std::vector< std::size_t > nodes( 1, m_size / node_keys + 1 );
+
+  while ( nodes.back() > 1 )
+    nodes.push_back( ( nodes.back() + node_keys ) / ( node_keys + 1 ) );
+
+  m_layers.resize( nodes.size() );
+  std::size_t key_count( 0 );
+
+  for ( std::size_t h( 0 ); h != nodes.size(); ++h )
+    {
+      m_layers[ h ] = key_count;
+      key_count += nodes[ h ] * node_keys;
+    }
+
+  storage keys( key_count + line_words, 0, m_storage.get_allocator() );
+  m_storage.swap( keys );
+
+  const std::uintptr_t address( std::uintptr_t( m_storage.data() ) );
+  const std::uintptr_t line_size( line_words * sizeof( std::uint64_t ) );
+  m_keys =
+    m_storage.data()
+    + ( line_size - address % line_size ) % line_size
+    / sizeof( std::uint64_t );
+
+  for ( std::size_t i( 0 ); i != nodes[ 0 ] * node_keys; ++i )
+    m_keys[ i ] = ( ( i < m_size ) ? codes[ i ] : UINT64_MAX ) ^ sign_bit;
+
+  // The key j of a node is the lowest code of its child j + 1, whose
+  // lowest codes are in the first node of the lowest layer under it. The
+  // missing children get the padding key.
+  std::size_t span( node_keys );
+
+  for ( std::size_t h( 1 ); h != nodes.size(); ++h )
+    {
+      std::uint64_t* const layer( m_keys + m_layers[ h ] );
+
+      for ( std::size_t b( 0 ); b != nodes[ h ]; ++b )
+        for ( std::size_t j( 0 ); j != node_keys; ++j )
+          {
+            const std::size_t i( ( b * ( node_keys + 1 ) + j + 1 ) * span );
+
+            layer[ b * node_keys + j ] =
+              ( ( i < m_size ) ? codes[ i ] : UINT64_MAX ) ^ sign_bit;
+          }
+
+      span *= node_keys + 1;
+    }
+}
+
+bool static_btree::contains( std::uint64_t code ) const
+{
+  const std::size_t position( rank( code ) );
+
+  return ( position < m_size ) & ( m_keys[ position ] == ( code ^ sign_bit ) );
+}
+
+std::size_t static_btree::rank( std::uint64_t code ) const
+{
+#if STATIC_BTREE_X86
+  if ( m_avx2 )
+    return lower_bound_avx2( m_keys, m_layers, code ^ sign_bit );
+#endif
+
+  return lower_bound_scalar( m_keys, m_layers, code ^ sign_bit );
+}
+
+std::size_t
+static_btree::count( const std::uint64_t* codes, std::size_t n ) const
+{
+#if STATIC_BTREE_X86
+  if ( m_avx2 )
+    return count_avx2( m_keys, m_layers, m_size, codes, n );
+#endif
+
+  return count_scalar( m_keys, m_layers, m_size, codes, n );
+}
+
+std::size_t static_btree::size() const
+{
+  return m_size;
+}
+
+std::size_t static_btree::memory_usage() const
+{
+  return m_storage.size() * sizeof( std::uint64_t );
+}
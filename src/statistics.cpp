@@ -0,0 +1,53 @@
+#include "statistics.hpp"
+
+#include <cmath>
+
+double student_t_975( std::size_t degrees )
+{
+  static const double table[] =
+    {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+  static const std::size_t table_size( sizeof( table ) / sizeof( table[ 0 ] ) );
+
+  assert( degrees != 0 );
+
+  if ( degrees <= table_size )
+    return table[ degrees - 1 ];
+
+  // Beyond 30 degrees of freedom the normal distribution is close enough.
+  return 1.96;
+}
+
+sample_summary summarize( const std::vector< double >& values )
+{
+  const std::size_t count( values.size() );
+  sample_summary result{ 0, 0, 0, 0 };
+
+  if ( count == 0 )
+    return result;
+
+  for ( double v : values )
+    result.mean += v;
+
+  result.mean /= count;
+
+  if ( count == 1 )
+    return result;
+  
+  double variance( 0 );
+
+  for ( double v : values )
+    variance += ( v - result.mean ) * ( v - result.mean );
+
+  result.stddev = std::sqrt( variance / ( count - 1 ) );
+  result.ci =
+    student_t_975( count - 1 ) * result.stddev / std::sqrt( double( count ) );
+
+  if ( result.mean != 0 )
+    result.cv = result.stddev / result.mean;
+
+  return result;
+}
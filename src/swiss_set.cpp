@@ -0,0 +1,3 @@
+#include "swiss_set.hpp"
+
+double g_max_load_factor( 0.875 );
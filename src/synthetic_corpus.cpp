@@ -0,0 +1,434 @@
+#include "synthetic_corpus.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <random>
+#include <set>
+
+namespace
+{
+  /** The weights of the options following a prefix. */
+  struct distribution
+  {
+    /** The weight of the end of the word then of each letter. */
+    std::vector< double > weights;
+
+    double total;
+
+    /** The index of the last non-zero weight. */
+    std::size_t last;
+  };
+  
+  /**
+   * Generates the keys of a synthetic corpus. Each frame of the stack
+   * splits the keys to produce below a prefix between the end of the word
+   * and the next letters. The keys which cannot be produced below a prefix,
+   * e.g. because it is too long, are given back to the parent frame which
+   * passes them to the next letters.
+   */
+  class markov_key_source:
+    public key_source
+  {
+  public:
+    markov_key_source
+    ( const markov_model& model, const synthetic_options& options,
+      std::uint32_t seed );
+
+    bool next( std::string& key ) override;
+
+  private:
+    struct frame
+    {
+      /** The number of keys still to produce with the current prefix. */
+      std::size_t count;
+
+      /** The state of the model after the prefix. */
+      std::size_t state;
+
+      const std::vector< double >* weights;
+
+      /** The sum of the weights from option to the last one. */
+      double remaining;
+
+      /** The index in weights of the next option to process. */
+      std::size_t option;
+
+      /** The index of the last option to process. */
+      std::size_t last;
+    };
+
+  private:
+    static distribution make_distribution( std::vector< double > weights );
+    
+    void push( std::size_t count, std::size_t state );
+
+  private:
+    const markov_model& m_model;
+    const synthetic_options& m_options;
+    std::mt19937_64 m_random;
+
+    /** The smoothed distribution of the model in each state. */
+    std::vector< distribution > m_distributions;
+
+    /**
+     * The distributions in each state for the prefixes shorter than the
+     * minimal length, thus without the end of the word.
+     */
+    std::vector< distribution > m_continuations;
+
+    /** The distribution for the prefixes of the maximal length. */
+    distribution m_end;
+
+    /** The prefix of the current frame. */
+    std::string m_key;
+
+    /**
+     * The frames of the prefixes of m_key, kept allocated when the
+     * traversal goes up.
+     */
+    std::vector< frame > m_stack;
+    std::size_t m_depth;
+  };
+}
+
+markov_key_source::markov_key_source
+( const markov_model& model, const synthetic_options& options,
+  std::uint32_t seed )
+  : m_model( model ),
+    m_options( options ),
+    m_random( seed ),
+    m_stack( options.max_length + 1 ),
+    m_depth( 0 )
+{
+  const std::size_t option_count( model.alphabet().size() + 1 );
+  const double uniform( 1.0 / option_count );
+
+  for ( std::size_t i( 0 ); model.has_state( i ); ++i )
+    {
+      const std::vector< double >& p( model.probabilities( i ) );
+      std::vector< double > weights( option_count );
+
+      for ( std::size_t j( 0 ); j != option_count; ++j )
+        weights[ j ] =
+          ( 1 - options.smoothing ) * p[ j ] + options.smoothing * uniform;
+
+      m_distributions.push_back( make_distribution( weights ) );
+
+      weights[ 0 ] = 0;
+
+      // The model may only know words ending here.
+      if ( std::all_of
+           ( weights.begin(), weights.end(),
+             []( double w ) -> bool
+             {
+               return w == 0;
+             } ) )
+        std::fill( weights.begin() + 1, weights.end(), 1 );
+
+      m_continuations.push_back( make_distribution( weights ) );
+    }
+
+  std::vector< double > end( option_count, 0 );
+  end[ 0 ] = 1;
+  m_end = make_distribution( end );
+  
+  push( options.keys, model.start() );
+}
+
+bool markov_key_source::next( std::string& key )
+{
+  while ( m_depth != 0 )
+    {
+      frame& f( m_stack[ m_depth - 1 ] );
+
+      if ( ( f.count == 0 ) || ( f.option > f.last ) )
+        {
+          const std::size_t unused( f.count );
+          --m_depth;
+
+          if ( m_depth != 0 )
+            {
+              m_key.pop_back();
+              m_stack[ m_depth - 1 ].count += unused;
+            }
+
+          continue;
+        }
+
+      const std::vector< double >& weights( *f.weights );
+      
+      // Most of the frames are for a single key, for which an option is
+      // picked at once instead of drawing a share for each of them.
+      if ( ( f.count == 1 ) && ( f.option != f.last ) )
+        {
+          double p
+            ( std::uniform_real_distribution< double >
+              ( 0, f.remaining )( m_random ) );
+
+          while ( ( f.option != f.last ) && ( p >= weights[ f.option ] ) )
+            {
+              p -= weights[ f.option ];
+              ++f.option;
+            }
+
+          f.last = f.option;
+          f.remaining = weights[ f.option ];
+        }
+      
+      const std::size_t option( f.option );
+      const double weight( weights[ option ] );
+      ++f.option;
+
+      if ( weight == 0 )
+        continue;
+
+      std::size_t share( f.count );
+
+      if ( option != f.last )
+        share =
+          std::binomial_distribution< std::size_t >
+          ( f.count, std::min( 1.0, weight / f.remaining ) )( m_random );
+
+      f.remaining -= weight;
+
+      if ( share == 0 )
+        continue;
+
+      // The keys are distinct, thus at most one of them ends here and the
+      // others go to the next letters.
+      if ( option == 0 )
+        {
+          --f.count;
+          key = m_key;
+          return true;
+        }
+
+      f.count -= share;
+      m_key += m_model.alphabet()[ option - 1 ];
+      push( share, m_model.next( f.state, option - 1 ) );
+    }
+
+  return false;
+}
+
+distribution markov_key_source::make_distribution
+( std::vector< double > weights )
+{
+  distribution result;
+  result.total = 0;
+  result.last = 0;
+
+  for ( std::size_t i( 0 ); i != weights.size(); ++i )
+    if ( weights[ i ] != 0 )
+      {
+        result.total += weights[ i ];
+        result.last = i;
+      }
+
+  result.weights.swap( weights );
+  return result;
+}
+
+void markov_key_source::push( std::size_t count, std::size_t state )
+{
+  const distribution* d;
+
+  if ( m_key.size() >= m_options.max_length )
+    d = &m_end;
+  else if ( m_key.size() < m_options.min_length )
+    d = &m_continuations[ state ];
+  else
+    d = &m_distributions[ state ];
+
+  frame& f( m_stack[ m_depth ] );
+  ++m_depth;
+
+  f.count = count;
+  f.state = state;
+  f.weights = &d->weights;
+  f.remaining = d->total;
+  f.option = 0;
+  f.last = d->last;
+}
+
+markov_model::markov_model
+( const std::vector< std::string >& words, const std::string& alphabet,
+  std::size_t order )
+  : m_order( order ),
+    m_longest( 0 )
+{
+  if ( alphabet.empty() )
+    {
+      std::set< char > letters;
+
+      for ( const std::string& w : words )
+        letters.insert( w.begin(), w.end() );
+
+      m_alphabet.assign( letters.begin(), letters.end() );
+    }
+  else
+    {
+      const std::set< char > letters( alphabet.begin(), alphabet.end() );
+      m_alphabet.assign( letters.begin(), letters.end() );
+    }
+
+  std::array< std::size_t, 256 > index;
+  index.fill( 0 );
+
+  for ( std::size_t i( 0 ); i != m_alphabet.size(); ++i )
+    index[ (unsigned char)m_alphabet[ i ] ] = i + 1;
+
+  const std::size_t options( m_alphabet.size() + 1 );
+  context_map contexts;
+
+  const auto state
+    ( [ & ]( const std::string& context ) -> std::size_t
+      {
+        const auto it( contexts.find( context ) );
+
+        if ( it != contexts.end() )
+          return it->second;
+
+        contexts[ context ] = m_probabilities.size();
+        m_probabilities.emplace_back( options );
+        return m_probabilities.size() - 1;
+      } );
+
+  state( std::string() );
+  
+  for ( const std::string& w : words )
+    {
+      if ( std::any_of
+           ( w.begin(), w.end(),
+             [ &index ]( char c ) -> bool
+             {
+               return index[ (unsigned char)c ] == 0;
+             } ) )
+        continue;
+
+      m_longest = std::max( m_longest, w.size() );
+
+      for ( std::size_t i( 0 ); i <= w.size(); ++i )
+        {
+          const std::size_t next
+            ( ( i == w.size() ) ? 0 : index[ (unsigned char)w[ i ] ] );
+          const std::string full( context( w.substr( 0, i ) ) );
+
+          // Count the letter in all the suffixes of the context, such that
+          // the generation can back off to a shorter context.
+          for ( std::size_t j( 0 ); j <= full.size(); ++j )
+            ++m_probabilities[ state( full.substr( j ) ) ][ next ];
+        }
+    }
+
+  for ( std::vector< double >& p : m_probabilities )
+    {
+      double sum( 0 );
+
+      for ( double v : p )
+        sum += v;
+
+      if ( sum == 0 )
+        std::fill( p.begin(), p.end(), 1.0 / options );
+      else
+        for ( double& v : p )
+          v /= sum;
+    }
+
+  m_start = find_state( contexts, context( std::string() ) );
+  m_transitions.resize( m_probabilities.size() * m_alphabet.size() );
+
+  for ( const auto& c : contexts )
+    for ( std::size_t i( 0 ); i != m_alphabet.size(); ++i )
+      {
+        std::string next( c.first + m_alphabet[ i ] );
+
+        if ( next.size() > m_order )
+          next.erase( 0, next.size() - m_order );
+
+        m_transitions[ c.second * m_alphabet.size() + i ] =
+          find_state( contexts, next );
+      }
+}
+
+const std::string& markov_model::alphabet() const
+{
+  return m_alphabet;
+}
+
+std::size_t markov_model::longest() const
+{
+  return m_longest;
+}
+
+bool markov_model::has_state( std::size_t state ) const
+{
+  return state < m_probabilities.size();
+}
+
+std::size_t markov_model::start() const
+{
+  return m_start;
+}
+
+std::size_t markov_model::next( std::size_t state, std::size_t letter ) const
+{
+  return m_transitions[ state * m_alphabet.size() + letter ];
+}
+
+const std::vector< double >&
+markov_model::probabilities( std::size_t state ) const
+{
+  return m_probabilities[ state ];
+}
+
+/**
+ * The last m_order letters of the prefix. Short prefixes are padded with a
+ * character out of the alphabet, such that the beginning of a word is not
+ * modeled like its middle.
+ */
+std::string markov_model::context( const std::string& prefix ) const
+{
+  if ( prefix.size() >= m_order )
+    return prefix.substr( prefix.size() - m_order );
+
+  return std::string( m_order - prefix.size(), '\1' ) + prefix;
+}
+
+/** The state of the longest suffix of the context seen in the training. */
+std::size_t markov_model::find_state
+( const context_map& contexts, std::string context ) const
+{
+  while ( true )
+    {
+      const auto it( contexts.find( context ) );
+
+      if ( it != contexts.end() )
+        return it->second;
+
+      context.erase( 0, 1 );
+    }
+}
+
+synthetic_corpus::synthetic_corpus
+( const std::vector< std::string >& training,
+  const synthetic_options& options, std::uint32_t seed )
+  : m_model( training, options.alphabet, options.order ),
+    m_options( options ),
+    m_seed( seed )
+{
+  if ( m_options.max_length == std::numeric_limits< std::size_t >::max() )
+    m_options.max_length = m_model.longest();
+
+  m_options.min_length =
+    std::min( m_options.min_length, m_options.max_length );
+
+  m_options.smoothing = std::max( 0.0, std::min( 1.0, m_options.smoothing ) );
+}
+
+std::unique_ptr< key_source > synthetic_corpus::keys() const
+{
+  return std::unique_ptr< key_source >
+    ( new markov_key_source( m_model, m_options, m_seed ) );
+}
@@ -3,8 +3,6 @@
 #include <algorithm>
 #include <cassert>
 #include <iostream>
-#include <limits>
-#include <unordered_map>
 
 trie::~trie()
 {
@@ -12,7 +10,7 @@ trie::~trie()
     delete c;
 }
 
-void insert( trie& t, const std::string& word )
+void insert( trie& t, word_view word )
 {
   trie* current( &t );
   
@@ -40,7 +38,7 @@ void insert( trie& t, const std::string& word )
   current->terminal = true;
 }
 
-bool find( const trie& t, const std::string& word )
+bool find( const trie& t, word_view word )
 {
   const trie* current( &t );
   
@@ -59,97 +57,45 @@ bool find( const trie& t, const std::string& word )
   return current->terminal;
 }
 
-typedef std::uint32_t offset_type;
-  
-void flatify( std::vector< std::uint8_t >& nodes, const trie& t )
+bool erase( trie& t, word_view word )
 {
-  const trie* current( &t );
-  std::unordered_map< const trie*, std::size_t > child_index;
+  // The deepest node on the path of the word which must be kept, and the
+  // index of the child leading to the word from this node.
+  trie* kept( &t );
+  std::size_t kept_child( 0 );
+  trie* current( &t );
 
-  std::vector< const trie* > pending( { &t } );
-  
-  for( std::size_t i( 0 ); i != pending.size(); ++i )
-  {
-    const trie* current( pending[ i ] );
-
-    child_index[ current ] = nodes.size();
-
-    const std::size_t child_count( current->keys.size() );
-    
-    nodes.push_back( child_count );
-
-    const std::size_t j( nodes.size() );
-    nodes.insert( nodes.end(), sizeof( std::uint32_t ), 0 );
-    std::uint32_t& letters
-      ( *reinterpret_cast< std::uint32_t* >( &nodes[ j ] ) );
-    assert( letters == 0 );
-    
-    for ( char c : current->keys )
-      letters |= ( 1 << ( c - 'A' ) );
-    
-    nodes.insert( nodes.end(), current->keys.begin(), current->keys.end() );
-    nodes.insert( nodes.end(), child_count * sizeof( offset_type ), 0 );
-
-    nodes.push_back( current->terminal );
-
-    pending.insert
-      ( pending.end(), current->children.begin(), current->children.end() );
-  }
-
-  std::size_t node( 0 );
-  for ( const trie* t : pending )
+  for ( char c : word )
     {
-      assert( nodes[ node ] == t->keys.size() );
-      
-      node += 1 + sizeof( std::uint32_t ) + t->keys.size();
+      const auto begin( current->keys.begin() );
+      const auto end( current->keys.end() );
+      const auto it( std::lower_bound( begin, end, c ) );
 
-      for ( const trie* c : t->children )
-        {
-          const std::size_t offset( child_index[ c ] - node );
-           
-          if ( offset > std::numeric_limits< offset_type >::max() )
-            std::cerr << "child is too far: " << offset << '\n';
+      if ( ( it == end ) || ( *it != c ) )
+        return false;
 
-          *reinterpret_cast< offset_type* >( &nodes[ node ] ) = offset;
-          node += sizeof( offset_type );
+      if ( current->terminal || ( current->keys.size() != 1 ) )
+        {
+          kept = current;
+          kept_child = it - begin;
         }
 
-      assert( nodes[ node ] == t->terminal );
-      
-      ++node;
+      current = current->children[ it - begin ];
     }
-}
 
-bool find( const std::vector< std::uint8_t >& nodes, const std::string& word )
-{
-  auto node( nodes.begin() );
-
-  for ( char c : word )
-    {
-      const std::size_t child_count( *node );
-      ++node;
-
-      const std::uint32_t letters
-        ( *reinterpret_cast< const std::uint32_t* >( &*node ) );
-
-      if ( ( letters & ( 1 << ( c - 'A' ) ) ) == 0 )
-        return false;
-
-      node += sizeof( letters );
-      const auto begin( node );
-      const auto end( begin + child_count );
-      const auto it( std::lower_bound( begin, end, c ) );
+  if ( !current->terminal )
+    return false;
 
-      assert( it != end );
+  current->terminal = false;
 
-      node = end + ( it - begin ) * sizeof( offset_type );
+  if ( !current->keys.empty() || ( current == &t ) )
+    return true;
 
-      node += *reinterpret_cast< const offset_type* >( &*node );
-    }
+  delete kept->children[ kept_child ];
+  kept->keys.erase( kept->keys.begin() + kept_child );
+  kept->children.erase( kept->children.begin() + kept_child );
 
-  node += 1 + sizeof( std::uint32_t ) + *node * ( 1 + sizeof( offset_type ) );
-  
-  return *node;
+  return true;
 }
 
 #define test( e ) \
@@ -187,7 +133,7 @@ void test_static()
   insert( t, "ACD" );
   insert( t, "BAD" );
 
-  std::vector< std::uint8_t > static_trie;
+  flat_trie static_trie;
   flatify( static_trie, t );
   
   test( find( static_trie, "ABC" ) );
@@ -202,10 +148,64 @@ void test_static()
   test( !find( static_trie, "B" ) );
 }
 
+void test_static_edge_cases()
+{
+  trie t;
+
+  insert( t, "" );
+  
+  for ( char c( 'A' ); c <= 'Z'; ++c )
+    {
+      insert( t, std::string( 1, c ) );
+      insert( t, std::string( "Z" ) + c );
+    }
+
+  flat_trie static_trie;
+  flatify( static_trie, t );
+
+  test( find( static_trie, "" ) );
+  test( find( static_trie, "A" ) );
+  test( find( static_trie, "Z" ) );
+  test( find( static_trie, "ZA" ) );
+  test( find( static_trie, "ZZ" ) );
+  test( !find( static_trie, "AA" ) );
+  test( !find( static_trie, "ZZZ" ) );
+}
+
+void test_erase()
+{
+  trie t;
+
+  insert( t, "abc" );
+  insert( t, "ab" );
+  insert( t, "acd" );
+  insert( t, "bad" );
+
+  test( !erase( t, "a" ) );
+  test( !erase( t, "abcd" ) );
+  test( erase( t, "ab" ) );
+  test( !find( t, "ab" ) );
+  test( find( t, "abc" ) );
+  test( erase( t, "abc" ) );
+  test( !find( t, "abc" ) );
+  test( find( t, "acd" ) );
+  test( t.children[ 0 ]->keys.size() == 1 );
+  test( erase( t, "bad" ) );
+  test( t.keys.size() == 1 );
+  test( !erase( t, "bad" ) );
+
+  insert( t, "" );
+  test( erase( t, "" ) );
+  test( !find( t, "" ) );
+  test( find( t, "acd" ) );
+}
+
 void test_trie()
 {
   test_simple();
   test_static();
+  test_static_edge_cases();
+  test_erase();
 }
 
 #undef test
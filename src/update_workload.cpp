@@ -0,0 +1,175 @@
+#include "update_workload.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <set>
+
+/**
+ * Generates up to count words absent from the given sorted words, by
+ * copying a letter of a word over another one. Thus the new words have the
+ * lengths and the letters of the corpus, and are supported by the same
+ * engines.
+ */
+static std::set< std::string > generate_new_words
+( const std::vector< std::string >& words, std::size_t count,
+  std::mt19937_64& random )
+{
+  std::set< std::string > result;
+  std::uniform_int_distribution< std::size_t > pick_word
+    ( 0, words.size() - 1 );
+
+  for ( std::size_t attempt( 0 );
+        ( result.size() != count ) && ( attempt != 10 * count ); ++attempt )
+    {
+      std::string w( words[ pick_word( random ) ] );
+
+      if ( w.size() < 2 )
+        continue;
+
+      std::uniform_int_distribution< std::size_t > pick_letter
+        ( 0, w.size() - 1 );
+      w[ pick_letter( random ) ] = w[ pick_letter( random ) ];
+
+      if ( !std::binary_search( words.begin(), words.end(), w ) )
+        result.insert( w );
+    }
+
+  return result;
+}
+
+update_workload generate_updates
+( const std::vector< std::string >& words, const update_options& options,
+  std::uint32_t seed )
+{
+  update_workload result;
+  result.expected_hits = 0;
+
+  if ( ( options.operations == 0 ) || words.empty() )
+    return result;
+
+  std::mt19937_64 random( seed );
+  std::vector< std::string > keys( words );
+  const std::set< std::string > new_words
+    ( generate_new_words
+      ( words,
+        std::max< std::size_t >( 1, options.operations * options.insert_ratio ),
+        random ) );
+
+  keys.insert( keys.end(), new_words.begin(), new_words.end() );
+  assert( keys.size() <= std::numeric_limits< std::uint32_t >::max() );
+
+  // The keys present in the dictionary and the others, with the position of
+  // each key in its vector such that it can be moved to the other one in
+  // constant time.
+  std::vector< std::uint32_t > present( words.size() );
+  std::vector< std::uint32_t > absent;
+  std::vector< std::size_t > position( keys.size() );
+
+  for ( std::size_t i( 0 ); i != keys.size(); ++i )
+    if ( i < words.size() )
+      {
+        present[ i ] = i;
+        position[ i ] = i;
+      }
+    else
+      {
+        position[ i ] = absent.size();
+        absent.push_back( i );
+      }
+
+  const auto move
+    ( [ &position ]
+      ( std::vector< std::uint32_t >& from, std::vector< std::uint32_t >& to,
+        std::size_t index ) -> std::uint32_t
+      {
+        const std::uint32_t key( from[ index ] );
+        from[ index ] = from.back();
+        position[ from[ index ] ] = index;
+        from.pop_back();
+
+        position[ key ] = to.size();
+        to.push_back( key );
+
+        return key;
+      } );
+  
+  std::uniform_real_distribution< double > pick_kind( 0, 1 );
+  std::uniform_int_distribution< std::uint32_t > pick_key
+    ( 0, keys.size() - 1 );
+  
+  result.operations.reserve( options.operations );
+
+  for ( std::size_t i( 0 ); i != options.operations; ++i )
+    {
+      const double kind( pick_kind( random ) );
+
+      if ( ( kind < options.insert_ratio ) && !absent.empty() )
+        result.operations.push_back
+          ( update_operation
+            {
+              update_kind::insert,
+              move
+              ( absent, present,
+                std::uniform_int_distribution< std::size_t >
+                ( 0, absent.size() - 1 )( random ) )
+            } );
+      else if ( ( kind >= options.insert_ratio )
+                && ( kind < options.insert_ratio + options.erase_ratio )
+                && !present.empty() )
+        result.operations.push_back
+          ( update_operation
+            {
+              update_kind::erase,
+              move
+              ( present, absent,
+                std::uniform_int_distribution< std::size_t >
+                ( 0, present.size() - 1 )( random ) )
+            } );
+      else
+        {
+          // A word of the corpus may have been erased, and a new word may
+          // have been inserted.
+          const std::uint32_t key( pick_key( random ) );
+          const bool hit
+            ( ( position[ key ] < present.size() )
+              && ( present[ position[ key ] ] == key ) );
+          
+          result.expected_hits += hit;
+          result.operations.push_back
+            ( update_operation{ update_kind::contains, key } );
+        }
+    }
+
+  result.keys = needle_arena( keys );
+  return result;
+}
+
+bool parse_update_mix( update_options& result, const char* mix )
+{
+  double ratios[ 3 ];
+  
+  for ( std::size_t i( 0 ); i != 3; ++i )
+    {
+      char* end;
+      ratios[ i ] = std::strtod( mix, &end );
+
+      if ( ( end == mix ) || ( ratios[ i ] < 0 )
+           || ( *end != ( ( i == 2 ) ? 0 : ':' ) ) )
+        return false;
+
+      mix = end + 1;
+    }
+
+  const double sum( ratios[ 0 ] + ratios[ 1 ] + ratios[ 2 ] );
+
+  if ( sum <= 0 )
+    return false;
+
+  result.insert_ratio = ratios[ 1 ] / sum;
+  result.erase_ratio = ratios[ 2 ] / sum;
+
+  return true;
+}
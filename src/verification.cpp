@@ -0,0 +1,466 @@
+#include "verification.hpp"
+
+#include "engine.hpp"
+#include "perfect_hash.hpp"
+#include "word_encoding.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+/** The number of divergences printed for each engine. */
+static constexpr std::size_t g_max_reported_errors( 10 );
+
+/** The number of probes checked on each fuzzed corpus. */
+static constexpr std::size_t g_fuzz_probes( 1000 );
+
+/**
+ * The number of codes of the perfect hash verified by fuzz_engines(), such
+ * that it has thousands of partitions.
+ */
+static constexpr std::size_t g_fuzz_perfect_hash_keys( 4000000 );
+
+/** The letters of the words, plus 'A' to 'Z'. */
+static std::string corpus_alphabet( const std::vector< std::string >& words )
+{
+  std::set< char > letters;
+
+  for ( char c( 'A' ); c <= 'Z'; ++c )
+    letters.insert( c );
+
+  for ( const std::string& w : words )
+    letters.insert( w.begin(), w.end() );
+
+  return std::string( letters.begin(), letters.end() );
+}
+
+std::vector< std::string > generate_probes
+( const std::vector< std::string >& words, std::size_t count,
+  std::uint32_t seed )
+{
+  std::mt19937 random( seed );
+  const std::string alphabet( corpus_alphabet( words ) );
+  std::uniform_int_distribution< std::size_t > letter
+    ( 0, alphabet.size() - 1 );
+
+  std::size_t longest( 0 );
+
+  for ( const std::string& w : words )
+    longest = std::max( longest, w.size() );
+
+  std::vector< std::string > result;
+  result.reserve( count );
+
+  for ( std::size_t i( 0 ); i != count; ++i )
+    {
+      std::string probe;
+
+      if ( !words.empty() )
+        probe =
+          words
+          [ std::uniform_int_distribution< std::size_t >
+            ( 0, words.size() - 1 )( random ) ];
+
+      switch ( std::uniform_int_distribution< int >( 0, 6 )( random ) )
+        {
+        case 0:
+          probe.resize
+            ( std::uniform_int_distribution< std::size_t >
+              ( 0, probe.size() )( random ) );
+          break;
+        case 1:
+          probe += alphabet[ letter( random ) ];
+          break;
+        case 2:
+          probe.insert
+            ( std::uniform_int_distribution< std::size_t >
+              ( 0, probe.size() )( random ),
+              1, alphabet[ letter( random ) ] );
+          break;
+        case 3:
+          if ( !probe.empty() )
+            probe.erase
+              ( std::uniform_int_distribution< std::size_t >
+                ( 0, probe.size() - 1 )( random ),
+                1 );
+          break;
+        case 4:
+          if ( !probe.empty() )
+            probe
+              [ std::uniform_int_distribution< std::size_t >
+                ( 0, probe.size() - 1 )( random ) ] =
+              alphabet[ letter( random ) ];
+          break;
+        case 5:
+          probe.assign( probe.rbegin(), probe.rend() );
+          break;
+        case 6:
+          probe.resize
+            ( std::uniform_int_distribution< std::size_t >
+              ( 0, longest + 1 )( random ) );
+
+          for ( char& c : probe )
+            c = alphabet[ letter( random ) ];
+          break;
+        }
+
+      result.push_back( probe );
+    }
+
+  return result;
+}
+
+static void check
+( const std::string& name, const engine& e, const std::string& word,
+  bool expected, std::size_t& errors )
+{
+  if ( e.contains( word ) == expected )
+    return;
+
+  if ( errors < g_max_reported_errors )
+    std::cerr << name
+              << ( expected ? " does not find the word \""
+                   : " finds the non-word \"" )
+              << word << "\".\n";
+
+  ++errors;
+}
+
+/** The number of keys starting with each probe. */
+typedef std::unordered_map< std::string, std::size_t > prefix_counts;
+
+static void check_prefix
+( const std::string& name, const engine& e, const std::string& prefix,
+  std::size_t expected, std::size_t& errors )
+{
+  std::size_t count;
+
+  if ( !e.count_prefix( prefix, count ) || ( count == expected ) )
+    return;
+
+  if ( errors < g_max_reported_errors )
+    std::cerr << name << " counts " << count << " words starting with \""
+              << prefix << "\" instead of " << expected << ".\n";
+
+  ++errors;
+}
+
+static bool verify_engine
+( const std::string& name, const corpus& c,
+  const std::set< std::string >& reference,
+  const prefix_counts& prefixes, const std::vector< std::string >& probes )
+{
+  const std::unique_ptr< engine > e( engine_registry::create( name ) );
+
+  if ( e == nullptr )
+    {
+      std::cerr << "Unknown engine: " << name << '\n';
+      return false;
+    }
+
+  // The engines which cannot store the corpus are not measured either.
+  if ( !supports_all( *e, *c.keys() ) )
+    return true;
+
+  try
+    {
+      e->build( *c.keys() );
+    }
+  catch( const std::exception& ex )
+    {
+      std::cerr << name << " failed to build: " << ex.what() << '\n';
+      return false;
+    }
+
+  std::size_t errors( 0 );
+  const std::unique_ptr< key_source > keys( c.keys() );
+  std::string key;
+
+  while ( keys->next( key ) )
+    check( name, *e, key, true, errors );
+
+  for ( const std::string& p : probes )
+    if ( e->supports( p ) )
+      check( name, *e, p, reference.find( p ) != reference.end(), errors );
+
+  for ( const auto& p : prefixes )
+    if ( e->supports( p.first ) )
+      check_prefix( name, *e, p.first, p.second, errors );
+
+  if ( errors == 0 )
+    return true;
+
+  std::cerr << name << " diverges from the reference on " << errors
+            << " lookups.\n";
+  return false;
+}
+
+/**
+ * Returns the probes which are keys of the corpus, found by merging the
+ * sorted probes with the stream of the keys such that the corpus is not
+ * stored.
+ */
+static std::set< std::string > find_probes
+( const corpus& c, const std::vector< std::string >& probes )
+{
+  std::vector< std::string > sorted( probes );
+  std::sort( sorted.begin(), sorted.end() );
+
+  std::set< std::string > result;
+  const std::unique_ptr< key_source > keys( c.keys() );
+  std::string key;
+  auto it( sorted.begin() );
+
+  while ( ( it != sorted.end() ) && keys->next( key ) )
+    {
+      it = std::lower_bound( it, sorted.end(), key );
+
+      if ( ( it != sorted.end() ) && ( *it == key ) )
+        result.insert( key );
+    }
+
+  return result;
+}
+
+/**
+ * Counts the keys of the corpus starting with each probe, by looking up
+ * every prefix of every key.
+ */
+static prefix_counts count_prefixes
+( const corpus& c, const std::vector< std::string >& probes )
+{
+  prefix_counts result;
+
+  for ( const std::string& p : probes )
+    result[ p ] = 0;
+
+  const std::unique_ptr< key_source > keys( c.keys() );
+  std::string key;
+  std::string prefix;
+
+  while ( keys->next( key ) )
+    for ( std::size_t i( 0 ); i <= key.size(); ++i )
+      {
+        prefix.assign( key, 0, i );
+        const auto it( result.find( prefix ) );
+
+        if ( it != result.end() )
+          ++it->second;
+      }
+
+  return result;
+}
+
+/** Tells if any of the given engines can answer prefix queries. */
+static bool answers_prefix_queries
+( const std::vector< std::string >& engines )
+{
+  std::size_t count;
+
+  for ( const std::string& name : engines )
+    {
+      const std::unique_ptr< engine > e( engine_registry::create( name ) );
+
+      if ( ( e != nullptr ) && e->count_prefix( std::string(), count ) )
+        return true;
+    }
+
+  return false;
+}
+
+bool verify_engines
+( const std::vector< std::string >& engines, const corpus& c,
+  const std::vector< std::string >& probes )
+{
+  const std::set< std::string > reference( find_probes( c, probes ) );
+
+  // Counting the prefixes scans the keys letter by letter, thus it is
+  // skipped if no engine needs it.
+  const prefix_counts prefixes
+    ( answers_prefix_queries( engines )
+      ? count_prefixes( c, probes ) : prefix_counts() );
+  bool result( true );
+
+  for ( const std::string& name : engines )
+    if ( !verify_engine( name, c, reference, prefixes, probes ) )
+      result = false;
+
+  return result;
+}
+
+std::vector< std::string > generate_fuzz_corpus
+( std::uint32_t seed, std::size_t max_length )
+{
+  std::mt19937 random( seed );
+  std::bernoulli_distribution coin( 0.5 );
+  std::uniform_int_distribution< int > letter( 'A', 'Z' );
+  std::uniform_int_distribution< std::size_t > length( 0, max_length );
+
+  const auto random_word
+    ( [ & ]( std::size_t size ) -> std::string
+      {
+        std::string result( size, ' ' );
+
+        for ( char& c : result )
+          c = letter( random );
+
+        return result;
+      } );
+
+  std::set< std::string > words;
+
+  if ( coin( random ) )
+    words.insert( std::string() );
+
+  if ( max_length == 0 )
+    return std::vector< std::string >( words.begin(), words.end() );
+
+  // Single letters, either all of them or some.
+  const bool all_letters( coin( random ) );
+
+  for ( char c( 'A' ); c <= 'Z'; ++c )
+    if ( all_letters || coin( random ) )
+      words.insert( std::string( 1, c ) );
+
+  // Long chains where every prefix is a word, and many words sharing them.
+  const std::size_t chains
+    ( std::uniform_int_distribution< std::size_t >( 1, 4 )( random ) );
+
+  for ( std::size_t i( 0 ); i != chains; ++i )
+    {
+      const std::string prefix
+        ( random_word
+          ( std::uniform_int_distribution< std::size_t >
+            ( 1, max_length )( random ) ) );
+
+      for ( std::size_t j( 1 ); j <= prefix.size(); ++j )
+        words.insert( prefix.substr( 0, j ) );
+
+      const std::size_t suffixes
+        ( std::uniform_int_distribution< std::size_t >( 0, 50 )( random ) );
+      std::uniform_int_distribution< std::size_t > suffix_length
+        ( 0, max_length - prefix.size() );
+
+      for ( std::size_t j( 0 ); j != suffixes; ++j )
+        words.insert( prefix + random_word( suffix_length( random ) ) );
+    }
+
+  // A node with all the letters as children, and sometimes all their
+  // children too.
+  const std::string parent
+    ( random_word
+      ( std::uniform_int_distribution< std::size_t >
+        ( 0, max_length - 1 )( random ) ) );
+  const bool two_levels
+    ( ( parent.size() + 2 <= max_length ) && coin( random ) );
+
+  for ( char c( 'A' ); c <= 'Z'; ++c )
+    {
+      words.insert( parent + c );
+
+      if ( two_levels )
+        for ( char d( 'A' ); d <= 'Z'; ++d )
+          words.insert( parent + c + d );
+    }
+
+  const std::size_t count
+    ( std::uniform_int_distribution< std::size_t >( 0, 500 )( random ) );
+
+  for ( std::size_t i( 0 ); i != count; ++i )
+    words.insert( random_word( length( random ) ) );
+
+  return std::vector< std::string >( words.begin(), words.end() );
+}
+
+bool verify_perfect_hash( std::size_t keys, std::uint32_t seed )
+{
+  std::mt19937_64 random( seed );
+  std::vector< std::uint64_t > codes( keys );
+
+  for ( std::uint64_t& code : codes )
+    code = random();
+
+  perfect_hash set;
+  set.build
+    ( codes, std::max( 1u, std::thread::hardware_concurrency() ) );
+
+  std::sort( codes.begin(), codes.end() );
+  codes.erase( std::unique( codes.begin(), codes.end() ), codes.end() );
+
+  if ( set.size() != codes.size() )
+    {
+      std::cerr << "The perfect hash of seed " << seed << " has "
+                << set.size() << " codes, expected " << codes.size()
+                << ".\n";
+      return false;
+    }
+
+  for ( std::uint64_t code : codes )
+    if ( !set.contains( code ) )
+      {
+        std::cerr << "The perfect hash of seed " << seed
+                  << " does not find the code " << code << ".\n";
+        return false;
+      }
+
+  for ( std::size_t i( 0 ); i != keys; ++i )
+    {
+      const std::uint64_t code( random() );
+
+      if ( set.contains( code )
+           != std::binary_search( codes.begin(), codes.end(), code ) )
+        {
+          std::cerr << "The perfect hash of seed " << seed
+                    << " finds the missing code " << code << ".\n";
+          return false;
+        }
+    }
+
+  return true;
+}
+
+bool fuzz_engines
+( const std::vector< std::string >& engines, std::size_t rounds,
+  std::uint32_t seed )
+{
+  const std::vector< std::string > names
+    ( engines.empty() ? engine_registry::names() : engines );
+
+  if ( ( std::find( names.begin(), names.end(), "mphf(code)" )
+         != names.end() )
+       && !verify_perfect_hash( g_fuzz_perfect_hash_keys, seed ) )
+    return false;
+
+  for ( std::size_t i( 0 ); i != rounds; ++i )
+    {
+      const std::uint32_t round_seed( seed + i );
+
+      // Some corpora have words too long for the codes, to check the
+      // engines which are not limited by them.
+      std::size_t max_length( g_max_encoded_length );
+
+      if ( round_seed % 4 == 2 )
+        max_length = g_max_encoded_length_128;
+      else if ( round_seed % 4 == 3 )
+        max_length = 4 * g_max_encoded_length;
+      const std::vector< std::string > words
+        ( generate_fuzz_corpus( round_seed, max_length ) );
+
+      if ( !verify_engines
+           ( names, word_list_corpus( words ),
+             generate_probes( words, g_fuzz_probes, round_seed ) ) )
+        {
+          std::cerr << "Divergence on the fuzzed corpus of seed "
+                    << round_seed << " (" << words.size()
+                    << " words of at most " << max_length << " letters).\n";
+          return false;
+        }
+    }
+
+  return true;
+}
@@ -1,18 +1,20 @@
 #include "word_encoding.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 static constexpr std::uint64_t g_letter_size_in_bits( 5 );
 static constexpr std::uint64_t g_letter_mask
 ( ( 1 << g_letter_size_in_bits ) - 1 );
         
-static std::uint64_t encode_word( const char* word )
+std::uint64_t encode_word( const char* word, std::size_t size )
 {
-    assert( word != nullptr );
+    assert( ( word != nullptr ) || ( size == 0 ) );
     
     std::uint64_t result( 0 );
+    const char* const end( word + size );
     
-    for ( const char* c( word ); *c != 0; ++c )
+    for ( const char* c( word ); c != end; ++c )
     {
         const std::uint64_t index( *c - 'A' + 1 );
         assert( index < ( 1 << g_letter_size_in_bits ) );
@@ -25,5 +27,159 @@ static std::uint64_t encode_word( const char* word )
 
 std::uint64_t encode_word( const std::string& word )
 {
-    return encode_word( word.c_str() );
+    return encode_word( word.data(), word.size() );
+}
+
+/** The bits of the length in the order preserving code. */
+static constexpr std::uint64_t g_length_mask( 0xf );
+
+std::uint64_t encode_word_ordered( const char* word, std::size_t size )
+{
+    assert( size <= g_max_encoded_length );
+    
+    // The codes of the letters are left-aligned, such that a missing letter
+    // compares as zero, before any letter.
+    return ( encode_word( word, size )
+             << ( 64 - g_letter_size_in_bits * size ) % 64 )
+        | size;
+}
+
+std::uint64_t encode_word_ordered( const std::string& word )
+{
+    return encode_word_ordered( word.data(), word.size() );
+}
+
+std::string decode_word( std::uint64_t code )
+{
+    std::string result( code & g_length_mask, ' ' );
+
+    for ( char& c : result )
+    {
+        c = 'A' - 1 + ( code >> ( 64 - g_letter_size_in_bits ) );
+        code <<= g_letter_size_in_bits;
+    }
+
+    return result;
+}
+
+void ordered_prefix_range
+( const char* prefix, std::size_t size, std::uint64_t& first,
+  std::uint64_t& last )
+{
+    first = encode_word_ordered( prefix, size );
+
+    // The longer words have their remaining letters and their length in the
+    // bits below the prefix.
+    const std::size_t free_bits( 64 - g_letter_size_in_bits * size );
+    const std::uint64_t below
+        ( ( free_bits == 64 )
+          ? ~std::uint64_t( 0 ) : ( std::uint64_t( 1 ) << free_bits ) - 1 );
+    
+    last = ( first & ~g_length_mask ) | below;
+}
+
+word_code_128 encode_word_128( const char* word, std::size_t size )
+{
+    assert( ( word != nullptr ) || ( size == 0 ) );
+    assert( size <= g_max_encoded_length_128 );
+    
+    word_code_128 result{ 0, 0 };
+    const char* const end( word + size );
+    
+    for ( const char* c( word ); c != end; ++c )
+    {
+        const std::uint64_t index( *c - 'A' + 1 );
+        assert( index < ( 1 << g_letter_size_in_bits ) );
+
+        result.high =
+            ( result.high << g_letter_size_in_bits )
+            | ( result.low >> ( 64 - g_letter_size_in_bits ) );
+        result.low = ( result.low << g_letter_size_in_bits ) | index;
+    }
+
+    return result;
+}
+
+multiword_code::multiword_code()
+    : m_words{ 0, 0 }
+{
+
+}
+
+multiword_code::multiword_code( std::size_t size )
+    : m_words{ 0, 0 }
+{
+    if ( size > inline_capacity )
+    {
+        m_words[ 0 ] = allocated_bit | size;
+        m_words[ 1 ] =
+            reinterpret_cast< std::uintptr_t >( new std::uint64_t[ size ] );
+    }
+}
+
+multiword_code::multiword_code( const multiword_code& that )
+    : m_words{ that.m_words[ 0 ], that.m_words[ 1 ] }
+{
+    if ( allocated() )
+    {
+        const std::size_t n( size() );
+        std::uint64_t* const words( new std::uint64_t[ n ] );
+
+        std::copy( that.heap(), that.heap() + n, words );
+        m_words[ 1 ] = reinterpret_cast< std::uintptr_t >( words );
+    }
+}
+
+multiword_code::multiword_code( multiword_code&& that ) noexcept
+    : multiword_code()
+{
+    swap( that );
+}
+
+multiword_code::~multiword_code()
+{
+    if ( allocated() )
+        delete[] heap();
+}
+
+multiword_code& multiword_code::operator=( multiword_code that ) noexcept
+{
+    swap( that );
+    return *this;
+}
+
+void multiword_code::swap( multiword_code& that ) noexcept
+{
+    std::swap( m_words[ 0 ], that.m_words[ 0 ] );
+    std::swap( m_words[ 1 ], that.m_words[ 1 ] );
+}
+
+multiword_code encode_word_multiword( const char* word, std::size_t size )
+{
+    assert( ( word != nullptr ) || ( size == 0 ) );
+
+    multiword_code result
+        ( ( size + g_max_encoded_length - 1 ) / g_max_encoded_length );
+    std::uint64_t* const words( result.data() );
+
+    for ( std::size_t i( 0 ); i < size; i += g_max_encoded_length )
+        words[ i / g_max_encoded_length ] =
+            encode_word
+            ( word + i, std::min( g_max_encoded_length, size - i ) );
+
+    return result;
+}
+
+bool is_uppercase_word( const std::string& word )
+{
+    for ( char c : word )
+        if ( ( c < 'A' ) || ( c > 'Z' ) )
+            return false;
+
+    return true;
+}
+
+bool is_encodable( const std::string& word )
+{
+    return ( word.size() <= g_max_encoded_length ) && is_uppercase_word( word );
 }
@@ -0,0 +1,313 @@
+#include "workload.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <random>
+
+namespace
+{
+  class workload_generator
+  {
+  public:
+    workload_generator
+    ( const std::vector< std::string >& words,
+      const workload_options& options, std::uint32_t seed );
+
+    bool empty() const;
+    
+    const std::string& hit();
+    std::string miss();
+
+  private:
+    bool is_word( const std::string& s ) const;
+
+    std::size_t pick_length();
+    
+    std::string random_letters();
+    std::string near_miss();
+    std::string prefix();
+
+  private:
+    const std::vector< std::string >& m_words;
+    const workload_options& m_options;
+    std::mt19937_64 m_random;
+
+    /** The indices of the candidate words, the most popular first. */
+    std::vector< std::size_t > m_by_rank;
+
+    /** The cumulative Zipf probabilities of the ranks in m_by_rank. */
+    std::vector< double > m_rank_cdf;
+
+    /** The lengths to pick from when generating random letters. */
+    std::vector< std::size_t > m_lengths;
+  };
+}
+
+workload_generator::workload_generator
+( const std::vector< std::string >& words, const workload_options& options,
+  std::uint32_t seed )
+  : m_words( words ),
+    m_options( options ),
+    m_random( seed )
+{
+  for ( std::size_t i( 0 ); i != words.size(); ++i )
+    if ( ( words[ i ].size() >= options.min_length )
+         && ( words[ i ].size() <= options.max_length ) )
+      m_by_rank.push_back( i );
+
+  if ( ( options.lengths == length_distribution::uniform )
+       && !m_by_rank.empty() )
+    {
+      // Pick the same number of words of each length, such that each
+      // length has the same probability at any rank.
+      std::size_t longest( 0 );
+
+      for ( std::size_t i : m_by_rank )
+        longest = std::max( longest, words[ i ].size() );
+      
+      std::vector< std::vector< std::size_t > > per_length
+        ( longest + 1 - options.min_length );
+
+      for ( std::size_t i : m_by_rank )
+        per_length[ words[ i ].size() - options.min_length ].push_back( i );
+
+      std::size_t count( m_by_rank.size() );
+
+      for ( const std::vector< std::size_t >& v : per_length )
+        if ( !v.empty() )
+          count = std::min( count, v.size() );
+
+      m_by_rank.clear();
+      
+      for ( std::vector< std::size_t >& v : per_length )
+        if ( !v.empty() )
+          {
+            std::shuffle( v.begin(), v.end(), m_random );
+            m_by_rank.insert( m_by_rank.end(), v.begin(), v.begin() + count );
+          }
+    }
+
+  // The popularity of a word must not depend on its position in the
+  // dictionary, otherwise the most frequent words would all share the same
+  // prefixes.
+  std::shuffle( m_by_rank.begin(), m_by_rank.end(), m_random );
+
+  const std::size_t count( m_by_rank.size() );
+  m_rank_cdf.resize( count );
+  m_lengths.reserve( count );
+  
+  double sum( 0 );
+  
+  for ( std::size_t i( 0 ); i != count; ++i )
+    {
+      sum += 1 / std::pow( i + 1, options.zipf_exponent );
+      m_rank_cdf[ i ] = sum;
+      m_lengths.push_back( words[ m_by_rank[ i ] ].size() );
+    }
+}
+
+bool workload_generator::empty() const
+{
+  return m_by_rank.empty();
+}
+
+const std::string& workload_generator::hit()
+{
+  assert( !m_by_rank.empty() );
+  
+  const double p
+    ( std::uniform_real_distribution< double >
+      ( 0, m_rank_cdf.back() )( m_random ) );
+  const std::size_t rank
+    ( std::min
+      ( m_rank_cdf.size() - 1,
+        std::size_t
+        ( std::lower_bound( m_rank_cdf.begin(), m_rank_cdf.end(), p )
+          - m_rank_cdf.begin() ) ) );
+
+  return m_words[ m_by_rank[ rank ] ];
+}
+
+std::string workload_generator::miss()
+{
+  // Some words may have no miss in their neighborhood (e.g. all prefixes
+  // are words too), thus we try some others before falling back to random
+  // letters, which quickly produce a miss.
+  for ( std::size_t attempt( 0 ); attempt != 100; ++attempt )
+    {
+      std::string result;
+      
+      switch ( m_options.misses )
+        {
+        case miss_kind::random_letters:
+          result = random_letters();
+          break;
+        case miss_kind::near_miss:
+          result = near_miss();
+          break;
+        case miss_kind::prefix:
+          result = prefix();
+          break;
+        }
+
+      if ( !is_word( result ) )
+        return result;
+    }
+
+  std::string result;
+
+  do
+    result = random_letters();
+  while ( is_word( result ) );
+
+  return result;
+}
+
+bool workload_generator::is_word( const std::string& s ) const
+{
+  return std::binary_search( m_words.begin(), m_words.end(), s );
+}
+
+std::size_t workload_generator::pick_length()
+{
+  return m_lengths
+    [ std::uniform_int_distribution< std::size_t >
+      ( 0, m_lengths.size() - 1 )( m_random ) ];
+}
+
+std::string workload_generator::random_letters()
+{
+  std::uniform_int_distribution< int > letter( 'A', 'Z' );
+  std::string result( pick_length(), ' ' );
+
+  for ( char& c : result )
+    c = letter( m_random );
+
+  return result;
+}
+
+std::string workload_generator::near_miss()
+{
+  std::string result( hit() );
+  std::uniform_int_distribution< int > letter( 'A', 'Z' );
+
+  switch ( std::uniform_int_distribution< int >( 0, 2 )( m_random ) )
+    {
+    case 0:
+      result.insert
+        ( std::uniform_int_distribution< std::size_t >
+          ( 0, result.size() )( m_random ),
+          1, letter( m_random ) );
+      break;
+    case 1:
+      if ( !result.empty() )
+        result.erase
+          ( std::uniform_int_distribution< std::size_t >
+            ( 0, result.size() - 1 )( m_random ),
+            1 );
+      break;
+    case 2:
+      if ( !result.empty() )
+        result
+          [ std::uniform_int_distribution< std::size_t >
+            ( 0, result.size() - 1 )( m_random ) ] = letter( m_random );
+      break;
+    }
+
+  return result;
+}
+
+std::string workload_generator::prefix()
+{
+  const std::string& word( hit() );
+
+  if ( word.size() <= 1 )
+    return word;
+  
+  return word.substr
+    ( 0,
+      std::uniform_int_distribution< std::size_t >
+      ( 1, word.size() - 1 )( m_random ) );
+}
+
+std::vector< std::string > generate_workload
+( const std::vector< std::string >& words, const workload_options& options,
+  std::uint32_t seed )
+{
+  std::vector< std::string > result;
+  workload_generator generator( words, options, seed );
+
+  if ( generator.empty() )
+    return result;
+  
+  result.reserve( options.queries );
+
+  std::mt19937 random( seed + 1 );
+  std::bernoulli_distribution is_hit( options.hit_ratio );
+  
+  for ( std::size_t i( 0 ); i != options.queries; ++i )
+    if ( is_hit( random ) )
+      result.push_back( generator.hit() );
+    else
+      result.push_back( generator.miss() );
+
+  return result;
+}
+
+std::vector< std::string > generate_prefixes
+( const std::vector< std::string >& words, std::size_t count,
+  std::uint32_t seed )
+{
+  std::vector< std::string > result;
+
+  if ( words.empty() )
+    return result;
+
+  result.reserve( count );
+  
+  std::mt19937 random( seed + 2 );
+  std::uniform_int_distribution< std::size_t > pick( 0, words.size() - 1 );
+
+  for ( std::size_t i( 0 ); i != count; ++i )
+    {
+      const std::string& word( words[ pick( random ) ] );
+      const std::size_t length
+        ( word.empty()
+          ? 0
+          : std::uniform_int_distribution< std::size_t >
+            ( 1, word.size() )( random ) );
+
+      result.push_back( word.substr( 0, length ) );
+    }
+
+  return result;
+}
+
+bool parse_miss_kind( miss_kind& result, const char* name )
+{
+  if ( std::strcmp( name, "random" ) == 0 )
+    result = miss_kind::random_letters;
+  else if ( std::strcmp( name, "edit" ) == 0 )
+    result = miss_kind::near_miss;
+  else if ( std::strcmp( name, "prefix" ) == 0 )
+    result = miss_kind::prefix;
+  else
+    return false;
+
+  return true;
+}
+
+bool parse_length_distribution( length_distribution& result, const char* name )
+{
+  if ( std::strcmp( name, "corpus" ) == 0 )
+    result = length_distribution::corpus;
+  else if ( std::strcmp( name, "uniform" ) == 0 )
+    result = length_distribution::uniform;
+  else
+    return false;
+
+  return true;
+}